@@ -0,0 +1,278 @@
+// batch driver: runs one pass of the library over a file of newline-separated
+// RPN formulas, one output line per input line, in input order.
+//
+// usage: ./batch <eval|nnf|cnf|sat> <input_file> [-j threads] [-o output_file]
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../boolean_algebra.hpp"
+
+enum class Pass { EVAL, NNF, CNF, SAT };
+
+// A contiguous range of whole lines of the mapped input, plus the output
+// produced for it. Chunks are handed out to workers and written back in order.
+struct Chunk {
+    const char *begin;
+    const char *end;
+    std::string out;
+    size_t formulas = 0;
+    bool done = false;
+};
+
+// Per-thread scratch memory, reused for every line the worker processes so
+// the hot loop does not allocate for the input copy or the chunk output.
+struct WorkerArena {
+    std::string line;
+    std::string out;
+};
+
+struct BatchState {
+    Pass pass;
+    std::vector<Chunk> chunks;
+    size_t next_chunk = 0;
+    size_t written = 0;
+    size_t window = 0;
+    std::mutex mutex;
+    std::condition_variable chunk_done;
+    std::condition_variable chunk_written;
+};
+
+static bool parse_pass(const std::string &name, Pass &pass) {
+    if (name == "eval") pass = Pass::EVAL;
+    else if (name == "nnf") pass = Pass::NNF;
+    else if (name == "cnf") pass = Pass::CNF;
+    else if (name == "sat") pass = Pass::SAT;
+    else return false;
+    return true;
+}
+
+static void run_pass(Pass pass, const std::string &formula, std::string &out) {
+    try {
+        switch (pass) {
+            case Pass::EVAL: out += eval_formula(formula) ? '1' : '0'; break;
+            case Pass::NNF: out += negation_normal_form(formula); break;
+            case Pass::CNF: out += conjunctive_normal_form(formula); break;
+            case Pass::SAT:
+                // sat() reports a malformed formula as unsatisfiable; check it
+                // first so it gets an error like the other passes
+                throw_eval_error(eval_rpn_runtime(formula, 0, true).status);
+                out += sat(formula) ? "SAT" : "UNSAT";
+                break;
+        }
+    } catch (const std::exception &e) {
+        if (std::strncmp(e.what(), "Error", 5) != 0) out += "Error: ";
+        out += e.what();
+    }
+}
+
+static void process_chunk(Pass pass, Chunk &chunk, WorkerArena &arena) {
+    arena.out.clear();
+
+    const char *p = chunk.begin;
+    while (p < chunk.end) {
+        const char *nl = static_cast<const char *>(std::memchr(p, '\n', chunk.end - p));
+        const char *line_end = nl ? nl : chunk.end;
+        const char *trimmed = line_end;
+        if (trimmed > p && trimmed[-1] == '\r') --trimmed;
+
+        if (trimmed > p) {
+            arena.line.assign(p, trimmed);
+            run_pass(pass, arena.line, arena.out);
+            ++chunk.formulas;
+        }
+        arena.out += '\n';
+        p = nl ? nl + 1 : chunk.end;
+    }
+
+    // hand the filled buffer to the chunk and keep a same-sized one for the next
+    chunk.out.reserve(arena.out.size());
+    chunk.out.swap(arena.out);
+}
+
+static void worker(BatchState &state) {
+    WorkerArena arena;
+    arena.out.reserve(1 << 20);
+
+    while (true) {
+        size_t index;
+        {
+            std::unique_lock<std::mutex> lock(state.mutex);
+            // bound the amount of finished-but-unwritten output held in memory
+            state.chunk_written.wait(lock, [&] {
+                return state.next_chunk >= state.chunks.size()
+                    || state.next_chunk < state.written + state.window;
+            });
+            if (state.next_chunk >= state.chunks.size()) return;
+            index = state.next_chunk++;
+        }
+
+        process_chunk(state.pass, state.chunks[index], arena);
+
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.chunks[index].done = true;
+        }
+        state.chunk_done.notify_all();
+    }
+}
+
+static void write_all(int fd, const char *data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("Error: write failed: ") + std::strerror(errno));
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+}
+
+// Splits [data, data + size) into chunks of roughly chunk_size bytes, each
+// ending just after a newline (or at the end of the input).
+static std::vector<Chunk> split_lines(const char *data, size_t size, size_t chunk_size) {
+    std::vector<Chunk> chunks;
+    const char *p = data;
+    const char *end = data + size;
+
+    while (p < end) {
+        const char *cut = (static_cast<size_t>(end - p) > chunk_size) ? p + chunk_size : end;
+        if (cut < end) {
+            const char *nl = static_cast<const char *>(std::memchr(cut, '\n', end - cut));
+            cut = nl ? nl + 1 : end;
+        }
+        Chunk chunk;
+        chunk.begin = p;
+        chunk.end = cut;
+        chunks.push_back(std::move(chunk));
+        p = cut;
+    }
+    return chunks;
+}
+
+static void usage() {
+    std::cerr << "usage: ./batch <eval|nnf|cnf|sat> <input_file> [-j threads] [-o output_file]" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        usage();
+        return 1;
+    }
+
+    BatchState state;
+    if (!parse_pass(argv[1], state.pass)) {
+        usage();
+        return 1;
+    }
+
+    const char *input_path = argv[2];
+    const char *output_path = nullptr;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (int i = 3; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output_path = argv[++i];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    int in_fd = ::open(input_path, O_RDONLY);
+    if (in_fd < 0) {
+        std::cerr << "Error: cannot open " << input_path << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+
+    struct stat st;
+    if (::fstat(in_fd, &st) < 0) {
+        std::cerr << "Error: cannot stat " << input_path << ": " << std::strerror(errno) << std::endl;
+        ::close(in_fd);
+        return 1;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+
+    const char *data = nullptr;
+    if (size > 0) {
+        void *mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, in_fd, 0);
+        if (mapped == MAP_FAILED) {
+            std::cerr << "Error: cannot map " << input_path << ": " << std::strerror(errno) << std::endl;
+            ::close(in_fd);
+            return 1;
+        }
+        ::madvise(mapped, size, MADV_SEQUENTIAL);
+        data = static_cast<const char *>(mapped);
+    }
+
+    int out_fd = STDOUT_FILENO;
+    if (output_path) {
+        out_fd = ::open(output_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out_fd < 0) {
+            std::cerr << "Error: cannot open " << output_path << ": " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+    }
+
+    // several chunks per thread for load balancing, but never tiny ones
+    size_t chunk_size = std::max<size_t>(size / (threads * 8) + 1, 256 * 1024);
+    state.chunks = split_lines(data, size, chunk_size);
+    state.window = threads * 4;
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t) {
+        pool.emplace_back(worker, std::ref(state));
+    }
+
+    size_t total = 0;
+    int status = 0;
+    try {
+        for (size_t i = 0; i < state.chunks.size(); ++i) {
+            {
+                std::unique_lock<std::mutex> lock(state.mutex);
+                state.chunk_done.wait(lock, [&] { return state.chunks[i].done; });
+            }
+            Chunk &chunk = state.chunks[i];
+            write_all(out_fd, chunk.out.data(), chunk.out.size());
+            total += chunk.formulas;
+            std::string().swap(chunk.out);
+            {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                state.written = i + 1;
+            }
+            state.chunk_written.notify_all();
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        status = 1;
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.next_chunk = state.chunks.size();
+        state.chunk_written.notify_all();
+    }
+
+    for (auto &t : pool) t.join();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (data) ::munmap(const_cast<char *>(data), size);
+    ::close(in_fd);
+    if (output_path) ::close(out_fd);
+
+    std::cerr << "batch: " << total << " formulas in " << seconds << " s ("
+              << (seconds > 0 ? static_cast<double>(total) / seconds : 0.0) << " formulas/sec, "
+              << threads << " threads)" << std::endl;
+    return status;
+}
@@ -0,0 +1,492 @@
+// benchmark suite for every exercise function
+//
+// make && ./bench                  (console)
+// make json                        (bench_results.json)
+// ./bench --benchmark_filter=CNF   (one family)
+
+#include <benchmark/benchmark.h>
+#include <random>
+#include <fcntl.h>
+#include <sstream>
+#include "../boolean_algebra.hpp"
+#include "../clause_set.hpp"
+#include "../sat_solver.hpp"
+#include "../minimize.hpp"
+#include "../formula_cse.hpp"
+#include "../formula_jit.hpp"
+#include "../wide_uint.hpp"
+
+// Formula builders. All inputs are deterministic so runs are comparable.
+
+// A1 & A2 & ... over the first n letters, with a contradiction appended so
+// exhaustive searches visit every assignment
+static std::string unsat_chain(int n) {
+    std::string f = "A";
+    for (int i = 1; i < n; ++i) {
+        f += static_cast<char>('A' + i);
+        f += '&';
+    }
+    return f + "A!&";
+}
+
+// A B & C | D ^ ... : every one of the first n letters, cycling operators
+static std::string variable_chain(int n) {
+    const char ops[] = "&|^>=";
+    std::string f = "A";
+    for (int i = 1; i < n; ++i) {
+        f += static_cast<char>('A' + i);
+        f += ops[(i - 1) % 5];
+    }
+    return f;
+}
+
+// (A & B) | (C & D) | ... : a DNF whose CNF has 2^(pairs) clauses
+static std::string dnf_pairs(int pairs) {
+    std::string f;
+    for (int i = 0; i < pairs; ++i) {
+        f += static_cast<char>('A' + 2 * i);
+        f += static_cast<char>('A' + 2 * i + 1);
+        f += '&';
+        if (i > 0) f += '|';
+    }
+    return f;
+}
+
+// random formula of exactly `operators` binary operators over `variables` letters
+static std::string random_formula(int operators, int variables, uint32_t seed) {
+    std::mt19937 rng(seed);
+    const char ops[] = "&|^>=";
+    std::string f(1, static_cast<char>('A' + rng() % variables));
+    int depth = 1;
+    int remaining = operators;
+
+    while (remaining > 0) {
+        // push operands while the stack is shallow, otherwise reduce
+        if (depth < 2 || (rng() % 2 && remaining > depth - 1)) {
+            f += static_cast<char>('A' + rng() % variables);
+            ++depth;
+        } else {
+            f += ops[rng() % 5];
+            --depth;
+            --remaining;
+        }
+        if (rng() % 6 == 0) f += '!';
+    }
+    return f;
+}
+
+// constant formula of the same shape, for eval_formula
+static std::string constant_formula(int operators, uint32_t seed) {
+    std::string f = random_formula(operators, 2, seed);
+    for (char &c : f) {
+        if (c == 'A') c = '0';
+        else if (c == 'B') c = '1';
+    }
+    return f;
+}
+
+// ex00 / ex01 / ex02
+
+static void BM_Adder(benchmark::State &state) {
+    // long carry chains: a + 1 ripples through `range` low one-bits
+    int a = static_cast<int>((1u << state.range(0)) - 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(adder(a, 1));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_Adder)->DenseRange(0, 30, 10);
+
+static void BM_Multiplier(benchmark::State &state) {
+    // the shift-and-add loop runs once per bit of the second operand
+    int b = static_cast<int>((1u << state.range(0)) - 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(multiplier(3, b));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_Multiplier)->DenseRange(1, 29, 7);
+
+// fixed-width integers: the same time for any operands, so one pair each
+template <size_t Bits>
+static void BM_WideAdd(benchmark::State &state) {
+    WideUInt<Bits> a = ~WideUInt<Bits>(), b(1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a);
+        benchmark::DoNotOptimize(a + b);
+    }
+}
+BENCHMARK_TEMPLATE(BM_WideAdd, 128);
+BENCHMARK_TEMPLATE(BM_WideAdd, 256);
+BENCHMARK_TEMPLATE(BM_WideAdd, 512);
+BENCHMARK_TEMPLATE(BM_WideAdd, 1024);
+
+template <size_t Bits>
+static void BM_WideMul(benchmark::State &state) {
+    WideUInt<Bits> a = ~WideUInt<Bits>() >> 3, b = ~WideUInt<Bits>() >> 5;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a);
+        benchmark::DoNotOptimize(a * b);
+    }
+}
+BENCHMARK_TEMPLATE(BM_WideMul, 128);
+BENCHMARK_TEMPLATE(BM_WideMul, 256);
+BENCHMARK_TEMPLATE(BM_WideMul, 512);
+BENCHMARK_TEMPLATE(BM_WideMul, 1024);
+
+// 1024 pairs: the batch kernels against the scalar operators in a loop
+template <size_t Bits, WideOp Op, bool Batch>
+static void BM_WideBatch(benchmark::State &state) {
+    std::mt19937_64 rng(1);
+    std::vector<WideUInt<Bits>> a(1024), b(a.size()), out(a.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        std::array<uint64_t, Bits / 64> x, y;
+        for (size_t l = 0; l < x.size(); ++l) {
+            x[l] = rng();
+            y[l] = rng();
+        }
+        a[i] = WideUInt<Bits>(x);
+        b[i] = WideUInt<Bits>(y);
+    }
+    for (auto _ : state) {
+        if (Batch) {
+            wide_batch<Bits, Op>(a.data(), b.data(), out.data(), a.size());
+        } else {
+            for (size_t i = 0; i < a.size(); ++i) out[i] = Op == WIDE_MUL ? a[i] * b[i] : a[i] + b[i];
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(a.size()));
+}
+BENCHMARK_TEMPLATE(BM_WideBatch, 256, WIDE_ADD, false);
+BENCHMARK_TEMPLATE(BM_WideBatch, 256, WIDE_ADD, true);
+BENCHMARK_TEMPLATE(BM_WideBatch, 1024, WIDE_ADD, false);
+BENCHMARK_TEMPLATE(BM_WideBatch, 1024, WIDE_ADD, true);
+BENCHMARK_TEMPLATE(BM_WideBatch, 256, WIDE_MUL, false);
+BENCHMARK_TEMPLATE(BM_WideBatch, 256, WIDE_MUL, true);
+
+static void BM_GrayCode(benchmark::State &state) {
+    std::vector<int> values(state.range(0));
+    for (size_t i = 0; i < values.size(); ++i) values[i] = static_cast<int>(i * 2654435761u);
+    for (auto _ : state) {
+        for (int v : values) benchmark::DoNotOptimize(gray_code(v));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_GrayCode)->Range(1 << 10, 1 << 16);
+
+// batch encode/decode over 32-bit words: dispatched (AVX2 where available)
+// against the portable loop
+template <bool Decode, bool Portable>
+static void BM_GrayBatch(benchmark::State &state) {
+    std::vector<uint32_t> in(static_cast<size_t>(state.range(0))), out(in.size());
+    for (size_t i = 0; i < in.size(); ++i) in[i] = static_cast<uint32_t>(i * 2654435761u);
+    for (auto _ : state) {
+        if (Decode && Portable) gray_decode_portable(in.data(), out.data(), in.size());
+        else if (Decode) gray_decode(in.data(), out.data(), in.size());
+        else if (Portable) gray_encode_portable(in.data(), out.data(), in.size());
+        else gray_encode(in.data(), out.data(), in.size());
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_GrayBatch, false, false)->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_GrayBatch, false, true)->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_GrayBatch, true, false)->Range(1 << 10, 1 << 16);
+BENCHMARK_TEMPLATE(BM_GrayBatch, true, true)->Range(1 << 10, 1 << 16);
+
+// walking a 16-bit sequence with a cursor, one flip per step
+static void BM_GrayCursor(benchmark::State &state) {
+    GraySequence sequence(16, static_cast<GrayOrder>(state.range(0)));
+    for (auto _ : state) {
+        GrayCursor cursor(sequence);
+        GrayStep step;
+        uint64_t flips = 0;
+        while (cursor.next(step)) flips += static_cast<uint64_t>(step.flipped);
+        benchmark::DoNotOptimize(flips);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(sequence.size()));
+}
+BENCHMARK(BM_GrayCursor)->DenseRange(GRAY_REFLECTED, GRAY_MONOTONE);
+
+// ex03 / ex04
+
+static void BM_EvalFormula(benchmark::State &state) {
+    std::string f = constant_formula(static_cast<int>(state.range(0)), 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(eval_formula(f));
+    }
+    state.SetBytesProcessed(state.iterations() * f.size());
+}
+BENCHMARK(BM_EvalFormula)->RangeMultiplier(4)->Range(4, 4096);
+
+// (X & Y) | (!X & !Y) nested n deep, as ex05 expands equivalences: the RPN
+// doubles per level, the distinct subexpressions grow by a constant
+static std::string nested_equivalences(int n) {
+    std::string f = "A";
+    for (int level = 1; level <= n; ++level) {
+        std::string y(1, static_cast<char>('A' + level));
+        f = f + y + "&" + f + "!" + y + "!&|";
+    }
+    return f;
+}
+
+static void BM_CseEvalSliced(benchmark::State &state) {
+    CseFormula cse(nested_equivalences(static_cast<int>(state.range(0))));
+    uint64_t columns[26];
+    for (int v = 0; v < 26; ++v) columns[v] = 0x9e3779b97f4a7c15ULL * (v + 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cse.eval_sliced(columns));
+    }
+    state.SetItemsProcessed(state.iterations() * 64);
+}
+BENCHMARK(BM_CseEvalSliced)->DenseRange(4, 16, 4);
+
+// the same formulas through the JIT, which evaluates every repetition
+static void BM_JitEvalSliced(benchmark::State &state) {
+    JitFormula jit(nested_equivalences(static_cast<int>(state.range(0))));
+    uint64_t columns[26];
+    for (int v = 0; v < 26; ++v) columns[v] = 0x9e3779b97f4a7c15ULL * (v + 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(jit.eval_sliced(columns));
+    }
+    state.SetItemsProcessed(state.iterations() * 64);
+}
+BENCHMARK(BM_JitEvalSliced)->DenseRange(4, 16, 4);
+
+// one formula over a columnar table of records, 64 per word
+static void BM_EvalBatch(benchmark::State &state) {
+    std::string f = random_formula(static_cast<int>(state.range(0)), 8, 5);
+    size_t n = size_t(1) << 20, words = n / 64;
+    std::mt19937_64 rng(1);
+    std::vector<uint64_t> columns(8 * words);
+    for (uint64_t &w : columns) w = rng();
+    CseFormula cse(f);
+    BitVector out;
+    for (auto _ : state) {
+        cse.eval_batch(columns.data(), n, out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_EvalBatch)->RangeMultiplier(4)->Range(4, 64);
+
+// n policies, each two to four of 32 common conditions joined: one shared
+// program over the records against one compiled formula per policy
+static std::vector<std::string> policies(int n) {
+    std::vector<std::string> conditions, out;
+    for (int i = 0; i < 32; ++i) conditions.push_back(random_formula(4, 10, static_cast<uint32_t>(i)));
+    std::mt19937 rng(11);
+    for (int i = 0; i < n; ++i) {
+        std::string p = conditions[rng() % 32];
+        for (int terms = 1 + rng() % 3; terms > 0; --terms) p += conditions[rng() % 32] + "&|>"[rng() % 3];
+        out.push_back(p);
+    }
+    return out;
+}
+
+static void BM_PoliciesShared(benchmark::State &state) {
+    CseProgram program(policies(static_cast<int>(state.range(0))));
+    std::vector<uint64_t> columns(10 * 256, 0x5555aaaa3333ccccULL);
+    std::vector<BitVector> out;
+    for (auto _ : state) {
+        program.eval_batch(columns.data(), 64 * 256, out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * 64 * 256 * state.range(0));
+}
+BENCHMARK(BM_PoliciesShared)->RangeMultiplier(4)->Range(64, 4096);
+
+static void BM_PoliciesSeparate(benchmark::State &state) {
+    std::vector<CseFormula> formulas;
+    for (const std::string &p : policies(static_cast<int>(state.range(0)))) formulas.emplace_back(p);
+    std::vector<uint64_t> columns(10 * 256, 0x5555aaaa3333ccccULL);
+    BitVector out;
+    for (auto _ : state) {
+        for (const CseFormula &f : formulas) {
+            f.eval_batch(columns.data(), 64 * 256, out);
+            benchmark::DoNotOptimize(out.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 64 * 256 * state.range(0));
+}
+BENCHMARK(BM_PoliciesSeparate)->RangeMultiplier(4)->Range(64, 4096);
+
+static void BM_PrintTruthTable(benchmark::State &state) {
+    std::string f = variable_chain(static_cast<int>(state.range(0)));
+    std::ostringstream sink;
+    std::streambuf *saved = std::cout.rdbuf(sink.rdbuf());
+    for (auto _ : state) {
+        print_truth_table(f);
+        sink.str("");
+    }
+    std::cout.rdbuf(saved);
+    state.SetItemsProcessed(state.iterations() * (int64_t(1) << state.range(0)));
+}
+BENCHMARK(BM_PrintTruthTable)->DenseRange(2, 14, 4);
+
+// straight to /dev/null in each format, bytes per second
+static void BM_WriteTruthTable(benchmark::State &state) {
+    std::string f = variable_chain(16);
+    TruthTableFormat format = static_cast<TruthTableFormat>(state.range(0));
+    int fd = ::open("/dev/null", O_WRONLY);
+    int64_t bytes = 0;
+    for (auto _ : state) {
+        TruthTableWriter writer(fd, format);
+        writer.write(f);
+        writer.flush();
+    }
+    ::close(fd);
+    std::ostringstream out;
+    TruthTableWriter(out, format).write(f);
+    bytes = static_cast<int64_t>(out.str().size());
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+BENCHMARK(BM_WriteTruthTable)->DenseRange(TRUTH_TABLE_TEXT, TRUTH_TABLE_MINTERMS);
+
+// ex05 / ex06 / ex07
+
+static void BM_NegationNormalForm(benchmark::State &state) {
+    std::string f = random_formula(static_cast<int>(state.range(0)), 8, 3);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(negation_normal_form(f));
+    }
+    state.SetBytesProcessed(state.iterations() * f.size());
+}
+BENCHMARK(BM_NegationNormalForm)->RangeMultiplier(2)->Range(4, 64);
+
+static void BM_ConjunctiveNormalForm(benchmark::State &state) {
+    std::string f = dnf_pairs(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(conjunctive_normal_form(f));
+    }
+    state.counters["clauses"] = static_cast<double>(int64_t(1) << state.range(0));
+}
+BENCHMARK(BM_ConjunctiveNormalForm)->DenseRange(1, 9, 2);
+
+static void BM_ConjunctiveNormalFormRandom(benchmark::State &state) {
+    std::string f = random_formula(static_cast<int>(state.range(0)), 6, 4);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(conjunctive_normal_form(f));
+    }
+}
+BENCHMARK(BM_ConjunctiveNormalFormRandom)->DenseRange(2, 6, 2);
+
+// the same inputs through the clause-set CNF
+static void BM_ConjunctiveNormalFormClauses(benchmark::State &state) {
+    std::string f = dnf_pairs(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(conjunctive_normal_form_clauses(f));
+    }
+    state.counters["clauses"] = static_cast<double>(int64_t(1) << state.range(0));
+}
+BENCHMARK(BM_ConjunctiveNormalFormClauses)->DenseRange(1, 9, 2);
+
+static void BM_ConjunctiveNormalFormClausesRandom(benchmark::State &state) {
+    std::string f = random_formula(static_cast<int>(state.range(0)), 6, 4);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(conjunctive_normal_form_clauses(f));
+    }
+}
+BENCHMARK(BM_ConjunctiveNormalFormClausesRandom)->DenseRange(2, 6, 2);
+
+static void BM_SatUnsatisfiable(benchmark::State &state) {
+    std::string f = unsat_chain(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sat(f));
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t(1) << state.range(0)));
+}
+BENCHMARK(BM_SatUnsatisfiable)->DenseRange(2, 14, 4);
+
+// one question per literal over the same formula: a fresh sat() call each
+// time against a single incremental solver under assumptions
+static void BM_SatQueries(benchmark::State &state) {
+    int n = static_cast<int>(state.range(0));
+    std::string f = variable_chain(n);
+    for (auto _ : state) {
+        for (int v = 0; v < n; ++v) {
+            std::string var(1, static_cast<char>('A' + v));
+            benchmark::DoNotOptimize(sat(f + var + "&"));
+            benchmark::DoNotOptimize(sat(f + var + "!&"));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 2 * n);
+}
+BENCHMARK(BM_SatQueries)->DenseRange(4, 12, 4);
+
+static void BM_SatSolverQueries(benchmark::State &state) {
+    int n = static_cast<int>(state.range(0));
+    SatSolver solver;
+    solver.add_formula(variable_chain(n));
+    for (auto _ : state) {
+        for (int v = 0; v < n; ++v) {
+            benchmark::DoNotOptimize(solver.solve({make_literal(v, false)}));
+            benchmark::DoNotOptimize(solver.solve({make_literal(v, true)}));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 2 * n);
+}
+BENCHMARK(BM_SatSolverQueries)->DenseRange(4, 12, 4);
+
+// two-level minimization: exact up to 10 variables, Espresso-style above
+static void BM_Minimize(benchmark::State &state) {
+    std::string f = random_formula(24, static_cast<int>(state.range(0)), 7);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(minimize(f));
+    }
+}
+BENCHMARK(BM_Minimize)->DenseRange(4, 16, 4);
+
+// ex08 / ex09
+
+static void BM_Powerset(benchmark::State &state) {
+    std::vector<int> set(state.range(0));
+    for (int i = 0; i < state.range(0); ++i) set[i] = i;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(powerset(set));
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t(1) << state.range(0)));
+}
+BENCHMARK(BM_Powerset)->DenseRange(4, 16, 4);
+
+static void BM_EvalSet(benchmark::State &state) {
+    // four overlapping sets of `range` elements each
+    int size = static_cast<int>(state.range(0));
+    std::vector<std::vector<int>> sets(4);
+    for (int s = 0; s < 4; ++s) {
+        for (int i = 0; i < size; ++i) sets[s].push_back(i * (s + 1));
+    }
+    std::string f = "AB&C|D^A>B=!";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(eval_set(f, sets));
+    }
+    state.SetItemsProcessed(state.iterations() * size * 4);
+}
+BENCHMARK(BM_EvalSet)->RangeMultiplier(4)->Range(16, 1024);
+
+// ex10 / ex11
+
+static void BM_Map(benchmark::State &state) {
+    std::mt19937 rng(5);
+    std::vector<std::pair<uint16_t, uint16_t>> points(state.range(0));
+    for (auto &p : points) p = {static_cast<uint16_t>(rng()), static_cast<uint16_t>(rng())};
+    for (auto _ : state) {
+        for (const auto &p : points) benchmark::DoNotOptimize(map(p.first, p.second));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Map)->Range(1 << 10, 1 << 14);
+
+static void BM_ReverseMap(benchmark::State &state) {
+    std::mt19937 rng(6);
+    std::vector<double> values(state.range(0));
+    for (auto &v : values) v = static_cast<double>(rng()) / static_cast<double>(0xFFFFFFFFu);
+    for (auto _ : state) {
+        for (double v : values) benchmark::DoNotOptimize(reverse_map(v));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ReverseMap)->Range(1 << 10, 1 << 14);
+
+BENCHMARK_MAIN();
@@ -23,9 +23,26 @@
 #include <algorithm>
 #include <set>
 #include <cstdint>
+#include <array>
+#include <string_view>
+#include <chrono>
+#include <sstream>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <unistd.h>
+#include <type_traits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <immintrin.h>
+#define GRAY_CODE_AVX2 1
+#else
+#define GRAY_CODE_AVX2 0
+#endif
 
 // ex00
-int adder(int a, int b) {
+inline int adder(int a, int b) {
 	while (b != 0) {
 		int sum = a ^ b;
 		int carry = (a & b) << 1;
@@ -38,7 +55,7 @@ int adder(int a, int b) {
 
 // ex01
 // helper to change int sign (O(1) - constant time)
-int negate(int n) {
+inline int negate(int n) {
     int all_ones = 0;
     for (int i = 0; i < 32; ++i) {
         all_ones = (all_ones << 1) | 1;
@@ -46,7 +63,7 @@ int negate(int n) {
     return adder(n ^ all_ones, 1);
 }
 
-int multiplier(int a, int b) {
+inline int multiplier(int a, int b) {
     if (a == 0 || b == 0) return 0;
 
     int result = 0;
@@ -68,12 +85,413 @@ int multiplier(int a, int b) {
 }
 
 // ex02
-int gray_code(int n) {
+inline int gray_code(int n) {
 	return n ^ (n >> 1);
 }
 
+// Gray codes over unsigned words, one at a time or over whole arrays. The
+// inverse is a prefix XOR from the top bit down, done in log2(bits) shifts:
+// after the shifts by 1, 2, ..., bits / 2, bit i holds the XOR of every bit
+// at or above it.
+template <typename UInt>
+constexpr UInt gray_encode(UInt x) {
+    static_assert(std::is_unsigned<UInt>::value, "gray_encode takes an unsigned type");
+    return x ^ (x >> 1);
+}
+
+template <typename UInt>
+constexpr UInt gray_decode(UInt g) {
+    static_assert(std::is_unsigned<UInt>::value, "gray_decode takes an unsigned type");
+    for (unsigned shift = 1; shift < sizeof(UInt) * 8; shift <<= 1) g ^= g >> shift;
+    return g;
+}
+
+template <typename UInt>
+inline void gray_encode_portable(const UInt *in, UInt *out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = gray_encode(in[i]);
+}
+
+template <typename UInt>
+inline void gray_decode_portable(const UInt *in, UInt *out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = gray_decode(in[i]);
+}
+
+#if GRAY_CODE_AVX2
+// Eight 32-bit or four 64-bit words per instruction; the tail goes through
+// the portable loop
+__attribute__((target("avx2"))) inline void gray_encode_avx2(const uint32_t *in, uint32_t *out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+        v = _mm256_xor_si256(v, _mm256_srli_epi32(v, 1));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), v);
+    }
+    gray_encode_portable(in + i, out + i, n - i);
+}
+
+// The shift/XOR steps of a decode depend on each other, so two vectors are
+// interleaved to keep the pipeline full
+__attribute__((target("avx2"))) inline void gray_decode_avx2(const uint32_t *in, uint32_t *out, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i + 8));
+        for (int shift = 1; shift < 32; shift <<= 1) {
+            a = _mm256_xor_si256(a, _mm256_srli_epi32(a, shift));
+            b = _mm256_xor_si256(b, _mm256_srli_epi32(b, shift));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), a);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i + 8), b);
+    }
+    gray_decode_portable(in + i, out + i, n - i);
+}
+
+__attribute__((target("avx2"))) inline void gray_encode_avx2(const uint64_t *in, uint64_t *out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+        v = _mm256_xor_si256(v, _mm256_srli_epi64(v, 1));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), v);
+    }
+    gray_encode_portable(in + i, out + i, n - i);
+}
+
+__attribute__((target("avx2"))) inline void gray_decode_avx2(const uint64_t *in, uint64_t *out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i + 4));
+        for (int shift = 1; shift < 64; shift <<= 1) {
+            a = _mm256_xor_si256(a, _mm256_srli_epi64(a, shift));
+            b = _mm256_xor_si256(b, _mm256_srli_epi64(b, shift));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), a);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i + 4), b);
+    }
+    gray_decode_portable(in + i, out + i, n - i);
+}
+#endif
+
+// whether the batch functions below run the AVX2 kernels on this machine
+inline bool gray_code_uses_avx2() {
+#if GRAY_CODE_AVX2
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+// n words from in to out (which may be the same array)
+inline void gray_encode(const uint32_t *in, uint32_t *out, size_t n) {
+#if GRAY_CODE_AVX2
+    if (gray_code_uses_avx2()) return gray_encode_avx2(in, out, n);
+#endif
+    gray_encode_portable(in, out, n);
+}
+
+inline void gray_encode(const uint64_t *in, uint64_t *out, size_t n) {
+#if GRAY_CODE_AVX2
+    if (gray_code_uses_avx2()) return gray_encode_avx2(in, out, n);
+#endif
+    gray_encode_portable(in, out, n);
+}
+
+inline void gray_decode(const uint32_t *in, uint32_t *out, size_t n) {
+#if GRAY_CODE_AVX2
+    if (gray_code_uses_avx2()) return gray_decode_avx2(in, out, n);
+#endif
+    gray_decode_portable(in, out, n);
+}
+
+inline void gray_decode(const uint64_t *in, uint64_t *out, size_t n) {
+#if GRAY_CODE_AVX2
+    if (gray_code_uses_avx2()) return gray_decode_avx2(in, out, n);
+#endif
+    gray_decode_portable(in, out, n);
+}
+
+// Gray code sequences
+//
+// GraySequence is the whole n-bit sequence in one of three orders, walked
+// lazily by GrayCursor, which reports the bit that flipped at every step so
+// callers can update their state incrementally. A cursor can start anywhere
+// and cover any number of steps, wrapping around cyclic orders, and split()
+// cuts the sequence into contiguous ranges for parallel enumeration.
+//
+// The reflected order is computed on the fly for up to 63 bits. The balanced
+// and monotone orders are built once into a table of codes, up to
+// kGrayTableBits bits:
+// - balanced (Robinson and Cohn): every bit flips 2^n / n times around the
+//   cycle, give or take 2, instead of bit 0 flipping half the time. An
+//   (n + 2)-bit code is built from an n-bit one whose cycle is cut into
+//   blocks at chosen transitions, and the choice sets the new flip counts.
+// - monotone (Savage and Winkler): a path, not a cycle, through the codes of
+//   weight 0 and 1, then 1 and 2, and so on, so the weight of a code is never
+//   more than one below any weight seen earlier.
+
+enum GrayOrder { GRAY_REFLECTED, GRAY_BALANCED, GRAY_MONOTONE };
+
+struct GrayStep {
+    uint64_t index;     // position in the sequence
+    uint64_t code;
+    int flipped;        // bit that changed from the previous step, -1 on a cursor's first step
+};
+
+struct GrayRange {
+    uint64_t start;
+    uint64_t count;
+};
+
+constexpr int kGrayTableBits = 20;
+
+// Flip count of every bit around the cycle (or along the path) of codes
+inline std::vector<uint64_t> gray_transition_counts(const std::vector<uint32_t> &codes, int bits, bool cyclic) {
+    std::vector<uint64_t> counts(static_cast<size_t>(bits), 0);
+    size_t steps = cyclic ? codes.size() : codes.size() - 1;
+    for (size_t i = 0; i < steps && codes.size() > 1; ++i) {
+        ++counts[static_cast<size_t>(__builtin_ctz(codes[i] ^ codes[(i + 1) % codes.size()]))];
+    }
+    return counts;
+}
+
+// (n + 2)-bit balanced cycle from the n-bit cycle g. The cycle is cut into
+// L blocks {g0}, B2, ..., B(L-1), {g-1} and laid out with the two new high
+// bits as 00 g0, then each middle block forward, backward and forward again
+// under the prefixes 00, 01, 11 (even blocks) or 11, 01, 00 (odd blocks),
+// then 00 g-1, all of g backward under 10, and 11 g0, 11 g-1, 01 g-1, 01 g0.
+// Old bit i then flips 4 * count(i) - 2 * cuts(i) times and each new bit L
+// times, so the cuts per bit are chosen to even those out.
+inline std::vector<uint32_t> gray_balanced_extend(const std::vector<uint32_t> &g, int n) {
+    size_t size = g.size();
+    std::vector<uint64_t> count = gray_transition_counts(g, n, true);
+    auto delta = [&](size_t k) { return __builtin_ctz(g[k] ^ g[(k + 1) % size]); };
+
+    // the cuts after g0, before g-1 and at the wrap are always there
+    std::vector<size_t> forced = {0, size - 2, size - 1};
+    forced.erase(std::unique(forced.begin(), forced.end()), forced.end());
+    std::vector<int64_t> forced_cuts(static_cast<size_t>(n), 0);
+    for (size_t k : forced) ++forced_cuts[static_cast<size_t>(delta(k))];
+
+    // try block counts L around 4 * size / (n + 2), each bit's cuts set to
+    // bring its flips closest to L, and keep the flattest spectrum
+    int64_t total = static_cast<int64_t>(4 * size);
+    int64_t target = total / (n + 2);
+    int64_t best_spread = -1;
+    std::vector<int64_t> best_cuts;
+    for (int64_t blocks = std::max<int64_t>(2, (target - 6) / 2 * 2); blocks <= target + 8; blocks += 2) {
+        std::vector<int64_t> cuts(static_cast<size_t>(n));
+        int64_t sum = 0;
+        for (int i = 0; i < n; ++i) {
+            int64_t c = 2 * static_cast<int64_t>(count[i]) - blocks / 2;
+            c = std::min<int64_t>(std::max(c, forced_cuts[i]), static_cast<int64_t>(count[i]));
+            cuts[i] = c;
+            sum += c;
+        }
+        auto flips = [&](int i) { return 4 * static_cast<int64_t>(count[i]) - 2 * cuts[i]; };
+        bool feasible = true;
+        while (feasible && sum != blocks) {
+            int pick = -1;
+            for (int i = 0; i < n; ++i) {
+                bool movable = sum < blocks ? cuts[i] < static_cast<int64_t>(count[i]) : cuts[i] > forced_cuts[i];
+                if (!movable) continue;
+                if (pick < 0 || (sum < blocks ? flips(i) > flips(pick) : flips(i) < flips(pick))) pick = i;
+            }
+            if (pick < 0) feasible = false;
+            else if (sum < blocks) { ++cuts[pick]; ++sum; }
+            else { --cuts[pick]; --sum; }
+        }
+        if (!feasible) continue;
+
+        int64_t low = blocks, high = blocks;
+        for (int i = 0; i < n; ++i) {
+            low = std::min(low, flips(i));
+            high = std::max(high, flips(i));
+        }
+        if (best_spread < 0 || high - low < best_spread) {
+            best_spread = high - low;
+            best_cuts = cuts;
+        }
+    }
+    if (best_spread < 0) throw std::logic_error("Error: no balanced Gray code partition");
+
+    // the first cuts at each bit, past the forced ones, end the blocks
+    std::vector<bool> cut(size, false);
+    for (size_t k : forced) cut[k] = true;
+    for (int i = 0; i < n; ++i) best_cuts[i] -= forced_cuts[i];
+    for (size_t k = 1; k + 2 < size; ++k) {
+        int64_t &left = best_cuts[static_cast<size_t>(delta(k))];
+        if (left > 0) { cut[k] = true; --left; }
+    }
+
+    std::vector<uint32_t> out;
+    out.reserve(4 * size);
+    auto emit = [&](uint32_t prefix, size_t i) { out.push_back((prefix << n) | g[i]); };
+    emit(0, 0);
+    size_t block = 2, first = 1;
+    for (size_t k = 1; k + 1 < size; ++k) {
+        if (!cut[k]) continue;
+        uint32_t outer = block % 2 == 0 ? 0 : 3, inner = block % 2 == 0 ? 3 : 0;
+        for (size_t i = first; i <= k; ++i) emit(outer, i);
+        for (size_t i = k + 1; i-- > first;) emit(1, i);
+        for (size_t i = first; i <= k; ++i) emit(inner, i);
+        first = k + 1;
+        ++block;
+    }
+    emit(0, size - 1);
+    for (size_t i = size; i-- > 0;) emit(2, i);
+    emit(3, 0);
+    emit(3, size - 1);
+    emit(1, size - 1);
+    emit(1, 0);
+    return out;
+}
+
+inline std::vector<uint32_t> gray_balanced_codes(int bits) {
+    if (bits == 0) return {0};
+    std::vector<uint32_t> codes = bits % 2 ? std::vector<uint32_t>{0, 1} : std::vector<uint32_t>{0, 1, 3, 2};
+    for (int n = bits % 2 ? 1 : 2; n < bits; n += 2) codes = gray_balanced_extend(codes, n);
+    return codes;
+}
+
+// Savage-Winkler path P(n, j) through the n-bit codes of weight j and j + 1:
+// P(1, 0) = 0, 1 and P(n, j) = 1 pi(P(n - 1, j - 1)), 0 P(n - 1, j), with the
+// new bit at the bottom and pi = perms[n - 1] permuting the lower bits
+inline void gray_monotone_path(int n, int j, bool reverse, const std::vector<std::vector<int>> &perms,
+                               std::vector<uint32_t> &out) {
+    if (j < 0 || j >= n) return;
+    if (n == 1) {
+        out.push_back(reverse ? 1 : 0);
+        out.push_back(reverse ? 0 : 1);
+        return;
+    }
+    const std::vector<int> &perm = perms[static_cast<size_t>(n - 1)];
+    auto permuted_half = [&](bool rev) {
+        size_t from = out.size();
+        gray_monotone_path(n - 1, j - 1, rev, perms, out);
+        for (size_t k = from; k < out.size(); ++k) {
+            uint32_t x = out[k], y = 0;
+            for (int i = 0; i < n - 1; ++i) y |= ((x >> perm[static_cast<size_t>(i)]) & 1) << i;
+            out[k] = (y << 1) | 1;
+        }
+    };
+    auto plain_half = [&](bool rev) {
+        size_t from = out.size();
+        gray_monotone_path(n - 1, j, rev, perms, out);
+        for (size_t k = from; k < out.size(); ++k) out[k] <<= 1;
+    };
+    if (!reverse) {
+        permuted_half(false);
+        plain_half(false);
+    } else {
+        plain_half(true);
+        permuted_half(true);
+    }
+}
+
+inline std::vector<uint32_t> gray_monotone_codes(int bits) {
+    // pi(0) = pi(1) = (0); pi(n) is pi(n - 1) extended by n - 1, composed with
+    // itself and rotated right by one
+    std::vector<std::vector<int>> perms(static_cast<size_t>(std::max(bits, 2)), std::vector<int>{0});
+    for (int n = 2; n < bits; ++n) {
+        std::vector<int> x = perms[static_cast<size_t>(n - 1)];
+        x.push_back(n - 1);
+        std::vector<int> y(x.size());
+        for (size_t k = 0; k < x.size(); ++k) y[k] = x[static_cast<size_t>(x[k])];
+        std::rotate(y.rbegin(), y.rbegin() + 1, y.rend());
+        perms[static_cast<size_t>(n)] = y;
+    }
+
+    std::vector<uint32_t> codes;
+    codes.reserve(size_t(1) << bits);
+    if (bits == 0) codes.push_back(0);
+    for (int j = 0; j < bits; ++j) gray_monotone_path(bits, j, j % 2 == 1, perms, codes);
+    return codes;
+}
+
+class GraySequence {
+public:
+    explicit GraySequence(int bits, GrayOrder order = GRAY_REFLECTED) : bits_(bits), order_(order) {
+        if (bits < 0 || bits > 63) throw std::invalid_argument("Error: Gray sequences take 0 to 63 bits");
+        if (order == GRAY_REFLECTED) return;
+        if (bits > kGrayTableBits) {
+            throw std::invalid_argument("Error: balanced and monotone Gray sequences take at most "
+                                        + std::to_string(kGrayTableBits) + " bits");
+        }
+        codes_ = order == GRAY_BALANCED ? gray_balanced_codes(bits) : gray_monotone_codes(bits);
+    }
+
+    int bits() const { return bits_; }
+    GrayOrder order() const { return order_; }
+    uint64_t size() const { return uint64_t(1) << bits_; }
+    // whether the last code is one bit away from the first; a lone code has
+    // no bit to flip, so a 0-bit sequence cannot wrap
+    bool cyclic() const { return bits_ > 0 && (order_ != GRAY_MONOTONE || bits_ == 1); }
+
+    uint64_t code(uint64_t index) const {
+        return order_ == GRAY_REFLECTED ? gray_encode(index) : codes_[index];
+    }
+
+    // the bit that flips from step index - 1 to step index; step 0 follows
+    // the last one on a cycle
+    int flipped(uint64_t index) const {
+        if (order_ == GRAY_REFLECTED) return index ? __builtin_ctzll(index) : bits_ - 1;
+        return __builtin_ctz(codes_[index] ^ codes_[(index ? index : codes_.size()) - 1]);
+    }
+
+    // `parts` contiguous ranges covering the sequence, as even as possible
+    std::vector<GrayRange> split(uint64_t parts) const {
+        parts = std::max<uint64_t>(1, std::min(parts, size()));
+        std::vector<GrayRange> ranges;
+        for (uint64_t p = 0, start = 0; p < parts; ++p) {
+            uint64_t count = size() / parts + (p < size() % parts ? 1 : 0);
+            ranges.push_back({start, count});
+            start += count;
+        }
+        return ranges;
+    }
+
+private:
+    int bits_;
+    GrayOrder order_;
+    std::vector<uint32_t> codes_;     // balanced and monotone orders
+};
+
+// Steps `count` codes of a sequence from `start`, wrapping around cycles
+class GrayCursor {
+public:
+    explicit GrayCursor(const GraySequence &sequence) : GrayCursor(sequence, 0, sequence.size()) {}
+    GrayCursor(const GraySequence &sequence, GrayRange range) : GrayCursor(sequence, range.start, range.count) {}
+    GrayCursor(const GraySequence &sequence, uint64_t start, uint64_t count)
+        : sequence_(&sequence), reflected_(sequence.order() == GRAY_REFLECTED), mask_(sequence.size() - 1),
+          remaining_(count) {
+        if (start >= sequence.size() || (!sequence.cyclic() && count > sequence.size() - start)) {
+            throw std::invalid_argument("Error: Gray cursor outside the sequence");
+        }
+        step_ = {start, sequence.code(start), -1};
+    }
+
+    bool next(GrayStep &step) {
+        if (remaining_ == 0) return false;
+        step = step_;
+        if (--remaining_ != 0) {
+            uint64_t index = (step_.index + 1) & mask_;
+            int bit = reflected_ && index ? __builtin_ctzll(index) : sequence_->flipped(index);
+            step_ = {index, step_.code ^ (uint64_t(1) << bit), bit};
+        }
+        return true;
+    }
+
+private:
+    const GraySequence *sequence_;
+    bool reflected_;
+    uint64_t mask_;
+    uint64_t remaining_;
+    GrayStep step_;     // the one next() returns
+};
+
 //ex03
-bool process_operand(bool a, bool b, char operand) {
+constexpr bool process_operand(bool a, bool b, char operand) {
     if (operand == '!') {
         return !b;
     } else if (operand == '&') {
@@ -89,107 +507,854 @@ bool process_operand(bool a, bool b, char operand) {
 	} else return (false); // will never reach this point
 }
 
-bool check_operand(const char c) {
-	char operands[] = {'!', '&', '|', '^', '>', '='};
+constexpr bool check_operand(const char c) {
+	const char operands[] = {'!', '&', '|', '^', '>', '='};
+
+	for (const char o : operands) {
+		if (c == o) { return (true); }
+	}
+
+	return (false);
+}
+
+// Outcome of eval_rpn_core: the core loop reports errors as a status instead
+// of throwing, so it can run inside constant expressions
+enum EvalStatus {
+    EVAL_OK,
+    EVAL_NOT_ENOUGH_OPERANDS,
+    EVAL_BAD_OPERAND,
+    EVAL_BAD_CONSTRUCTION,
+    EVAL_TOO_DEEP
+};
+
+struct EvalResult {
+    EvalStatus status;
+    bool value;
+};
+
+// Bit-packed operand stack with a fixed capacity (usable in constexpr)
+template <size_t Capacity>
+struct BitStack {
+    uint64_t words[(Capacity + 63) / 64] = {};
+    size_t size = 0;
+
+    constexpr bool full() const { return size == Capacity; }
+    constexpr void push(bool value) {
+        uint64_t bit = uint64_t(1) << (size % 64);
+        if (value) words[size / 64] |= bit;
+        else words[size / 64] &= ~bit;
+        ++size;
+    }
+    constexpr bool pop() {
+        --size;
+        return (words[size / 64] >> (size % 64)) & 1;
+    }
+};
+
+// Growable bit-packed operand stack for formulas too long for a BitStack
+struct DynamicBitStack {
+    std::vector<uint64_t> words;
+    size_t size = 0;
+
+    bool full() const { return false; }
+    void push(bool value) {
+        if (size / 64 >= words.size()) words.push_back(0);
+        uint64_t bit = uint64_t(1) << (size % 64);
+        if (value) words[size / 64] |= bit;
+        else words[size / 64] &= ~bit;
+        ++size;
+    }
+    bool pop() {
+        --size;
+        return (words[size / 64] >> (size % 64)) & 1;
+    }
+};
+
+// Stack machine shared by eval_formula, the truth tables and sat. When
+// allow_variables is set, a letter pushes bit (letter - 'A') of assignment.
+template <typename Stack>
+constexpr EvalResult eval_rpn_core(std::string_view expression, uint32_t assignment,
+                                   bool allow_variables, Stack &data) {
+    for (char c : expression) {
+        if (c == '0' || c == '1' || (allow_variables && c >= 'A' && c <= 'Z')) {
+            if (data.full()) return {EVAL_TOO_DEEP, false};
+            data.push(c >= 'A' ? ((assignment >> (c - 'A')) & 1) : c == '1');
+        } else if (c == '!') {
+            if (data.size == 0) return {EVAL_NOT_ENOUGH_OPERANDS, false};
+            data.push(!data.pop());
+        } else if (check_operand(c)) {
+            if (data.size < 2) return {EVAL_NOT_ENOUGH_OPERANDS, false};
+            bool b = data.pop();
+            bool a = data.pop();
+            data.push(process_operand(a, b, c));
+        } else {
+            return {EVAL_BAD_OPERAND, false};
+        }
+    }
+
+    if (data.size != 1) return {EVAL_BAD_CONSTRUCTION, false};
+    return {EVAL_OK, data.pop()};
+}
+
+// Constant-expression evaluation of formulas up to 1024 operands deep
+constexpr EvalResult eval_rpn(std::string_view expression, uint32_t assignment = 0) {
+    BitStack<1024> data;
+    return eval_rpn_core(expression, assignment, true, data);
+}
+
+inline void throw_eval_error(EvalStatus status) {
+    switch (status) {
+        case EVAL_OK: return;
+        case EVAL_NOT_ENOUGH_OPERANDS:
+            throw std::invalid_argument("Error: Invalid RPN expression: not enough operands");
+        case EVAL_BAD_OPERAND:
+            throw std::invalid_argument("Error: Invalid RPN expression: bad operand");
+        case EVAL_BAD_CONSTRUCTION:
+            throw std::invalid_argument("Error: Invalid RPN expression: bad construction");
+        case EVAL_TOO_DEEP:
+            throw std::invalid_argument("Error: Invalid RPN expression: too deep");
+    }
+}
+
+// Runs eval_rpn_core on a fixed stack when the expression is short enough to
+// fit, so the common case does not allocate
+inline EvalResult eval_rpn_runtime(std::string_view expression, uint32_t assignment, bool allow_variables) {
+    if (expression.size() <= 1024) {
+        BitStack<1024> data;
+        return eval_rpn_core(expression, assignment, allow_variables, data);
+    }
+    DynamicBitStack data;
+    return eval_rpn_core(expression, assignment, allow_variables, data);
+}
+
+inline bool eval_formula(const std::string &expression) {
+    EvalResult result = eval_rpn_runtime(expression, 0, false);
+    throw_eval_error(result.status);
+    return result.value;
+}
+
+// Resource limits
+//
+// The expensive entry points (negation_normal_form, conjunctive_normal_form,
+// sat, print_truth_table) have overloads taking ResourceLimits. The limits
+// are installed for the calling thread while the call runs and checked
+// cooperatively on every AST node allocation, emitted RPN fragment and
+// truth-table row; a limit that trips unwinds the call, which then returns
+// the matching LimitStatus instead of a value.
+
+class CancellationToken {
+public:
+    void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+    void reset() { cancelled_.store(false, std::memory_order_relaxed); }
+    bool cancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<bool> cancelled_{false};
+};
+
+enum LimitStatus {
+    LIMIT_OK,
+    LIMIT_NODES,
+    LIMIT_MEMORY,
+    LIMIT_DEADLINE,
+    LIMIT_CANCELLED
+};
+
+inline const char *limit_status_name(LimitStatus status) {
+    switch (status) {
+        case LIMIT_OK: return "ok";
+        case LIMIT_NODES: return "node budget exceeded";
+        case LIMIT_MEMORY: return "memory budget exceeded";
+        case LIMIT_DEADLINE: return "deadline exceeded";
+        case LIMIT_CANCELLED: return "cancelled";
+    }
+    return "unknown";
+}
+
+struct ResourceLimits {
+    uint64_t max_nodes = 0;             // live AST nodes, 0 for no limit
+    uint64_t max_memory_bytes = 0;      // AST nodes plus the RPN being emitted, 0 for no limit
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    const CancellationToken *cancel = nullptr;
+
+    static ResourceLimits timeout(std::chrono::steady_clock::duration budget) {
+        ResourceLimits limits;
+        limits.deadline = std::chrono::steady_clock::now() + budget;
+        return limits;
+    }
+};
+
+template <typename T>
+struct Limited {
+    LimitStatus status;
+    T value;
+
+    bool ok() const { return status == LIMIT_OK; }
+};
+
+// thrown inside a limited call, caught by run_with_limits
+struct ResourceLimitExceeded : std::runtime_error {
+    LimitStatus status;
+
+    explicit ResourceLimitExceeded(LimitStatus s)
+        : std::runtime_error(std::string("Error: ") + limit_status_name(s)), status(s) {}
+};
+
+struct ActiveLimits {
+    const ResourceLimits *limits;
+    uint64_t base_nodes;        // live AST nodes when the call started
+    uint64_t base_operand_bytes; // and bytes held by AST operand arrays
+    uint32_t countdown;         // polls left before the next clock/token check
+};
+
+inline thread_local ActiveLimits *active_limits = nullptr;
+inline thread_local uint64_t ast_live_nodes = 0;
+inline thread_local uint64_t ast_operand_bytes = 0;
+
+// Deadline and cancellation checks. Reading the clock costs more than the
+// work between two polls, so it happens once every 256 polls.
+inline void limit_poll() {
+    ActiveLimits *active = active_limits;
+    if (!active || --active->countdown != 0) return;
+
+    active->countdown = 256;
+    const ResourceLimits &limits = *active->limits;
+    if (limits.cancel && limits.cancel->cancelled()) throw ResourceLimitExceeded(LIMIT_CANCELLED);
+    if (std::chrono::steady_clock::now() > limits.deadline) throw ResourceLimitExceeded(LIMIT_DEADLINE);
+}
+
+// Installs limits for the calling thread, restoring the enclosing ones on exit
+class LimitScope {
+public:
+    explicit LimitScope(const ResourceLimits &limits)
+        : active_{&limits, ast_live_nodes, ast_operand_bytes, 1}, previous_(active_limits) {
+        active_limits = &active_;
+    }
+    ~LimitScope() { active_limits = previous_; }
+
+    LimitScope(const LimitScope &) = delete;
+    LimitScope &operator=(const LimitScope &) = delete;
+
+private:
+    ActiveLimits active_;
+    ActiveLimits *previous_;
+};
+
+template <typename T, typename F>
+Limited<T> run_with_limits(const ResourceLimits &limits, F &&f) {
+    LimitScope scope(limits);
+    try {
+        limit_poll();   // a cancelled token or past deadline stops the call up front
+        return {LIMIT_OK, f()};
+    } catch (const ResourceLimitExceeded &e) {
+        return {e.status, T{}};
+    }
+}
+
+// ex04
+// Bitmask of the variables A-Z used by the expression
+constexpr uint32_t formula_variables(std::string_view expression) {
+    uint32_t variables = 0;
+    for (char c : expression) {
+        if (c >= 'A' && c <= 'Z') variables |= uint32_t(1) << (c - 'A');
+    }
+    return variables;
+}
+
+constexpr int count_variables(uint32_t variables) {
+    int n = 0;
+    for (; variables; variables &= variables - 1) ++n;
+    return n;
+}
+
+// Assignment for truth-table row `row`: the alphabetically first variable is
+// the most significant bit of the row index, as in print_truth_table
+constexpr uint32_t row_assignment(uint32_t variables, int n, uint64_t row) {
+    uint32_t assignment = 0;
+    int j = 0;
+    for (int v = 0; v < 26; ++v) {
+        if (!((variables >> v) & 1)) continue;
+        if ((row >> (n - 1 - j)) & 1) assignment |= uint32_t(1) << v;
+        ++j;
+    }
+    return assignment;
+}
+
+// Number of 64-bit words needed for the packed truth table of expression
+constexpr size_t truth_table_words(std::string_view expression) {
+    return ((size_t(1) << count_variables(formula_variables(expression))) + 63) / 64;
+}
+
+// Packed truth table: bit (row % 64) of word (row / 64) is the result of the
+// row print_truth_table would print at that position
+template <size_t Words>
+constexpr std::array<uint64_t, Words> truth_table(std::string_view expression) {
+    uint32_t variables = formula_variables(expression);
+    int n = count_variables(variables);
+    if (((size_t(1) << n) + 63) / 64 != Words) {
+        throw std::invalid_argument("Error: truth table size does not match the number of variables");
+    }
+
+    std::array<uint64_t, Words> table = {};
+    for (uint64_t row = 0; row < (uint64_t(1) << n); ++row) {
+        EvalResult result = eval_rpn(expression, row_assignment(variables, n, row));
+        if (result.status != EVAL_OK) {
+            throw std::invalid_argument("Error: invalid expression for truth table");
+        }
+        if (result.value) table[row / 64] |= uint64_t(1) << (row % 64);
+    }
+    return table;
+}
+
+// Truth-table output
+//
+// TruthTableWriter streams a table row block by row block, so tables too
+// large to hold in memory are never built. Each block of 64 rows is
+// evaluated bit-sliced in one pass over the RPN: the low six bits of the row
+// index are fixed bit patterns and the higher ones are constant across the
+// block. Rows are formatted into one reusable buffer, which goes to a file
+// descriptor or a stream whenever it fills, never per row.
+
+enum TruthTableFormat {
+    TRUTH_TABLE_TEXT,       // "A | B | Result" header and rows, as print_truth_table
+    TRUTH_TABLE_CSV,        // "A,B,Result" header and rows
+    TRUTH_TABLE_BINARY,     // the result column alone, row r in bit r % 8 of byte r / 8
+    TRUTH_TABLE_MINTERMS,   // the index of every true row, one per line
+};
+
+class TruthTableWriter {
+public:
+    explicit TruthTableWriter(int fd, TruthTableFormat format = TRUTH_TABLE_TEXT) : fd_(fd), format_(format) {
+        buffer_.reserve(kBufferSize + 256);
+    }
+    explicit TruthTableWriter(std::ostream &out, TruthTableFormat format = TRUTH_TABLE_TEXT)
+        : stream_(&out), format_(format) {
+        buffer_.reserve(kBufferSize + 256);
+    }
+    ~TruthTableWriter() {
+        try {
+            flush();
+        } catch (const std::exception &) {
+        }
+    }
+
+    TruthTableWriter(const TruthTableWriter &) = delete;
+    TruthTableWriter &operator=(const TruthTableWriter &) = delete;
+
+    void write(const std::string &expression) {
+        uint32_t variables = 0;
+        for (const char c : expression) {
+            if (c >= 'A' && c <= 'Z') {
+                variables |= uint32_t(1) << (c - 'A');
+            } else if (c == '1' || c == '0') {
+                throw std::invalid_argument("Error: invalid expression for truth table: only A-Z characters and valid operators admitted");
+            }
+        }
+        throw_eval_error(eval_rpn_runtime(expression, 0, true).status);
+
+        int n = count_variables(variables);
+        uint64_t rows = uint64_t(1) << n;
+        header(variables, n);
+
+        uint64_t columns[26] = {};
+        for (uint64_t base = 0; base < rows; base += 64) {
+            limit_poll();
+            // the j-th variable is bit n - 1 - j of the row index
+            for (int v = 0, j = 0; v < 26; ++v) {
+                if (!((variables >> v) & 1)) continue;
+                int bit = n - 1 - j++;
+                columns[v] = bit < 6 ? kRowPatterns[bit] : uint64_t(0) - ((base >> bit) & 1);
+            }
+            uint64_t count = std::min<uint64_t>(64, rows - base);
+            emit_block(eval_block(expression, columns), base, count, n);
+            if (buffer_.size() >= kBufferSize) flush();
+        }
+    }
+
+    void flush() {
+        if (stream_) {
+            stream_->write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+            stream_->flush();
+            buffer_.clear();
+            return;
+        }
+        const char *data = buffer_.data();
+        size_t size = buffer_.size();
+        while (size > 0) {
+            ssize_t written = ::write(fd_, data, size);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                buffer_.clear();
+                throw std::runtime_error(std::string("Error: write failed: ") + std::strerror(errno));
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+        buffer_.clear();
+    }
+
+private:
+    static constexpr size_t kBufferSize = 1 << 16;
+    // bit i of kRowPatterns[b] is bit b of i
+    static constexpr uint64_t kRowPatterns[6] = {0xAAAAAAAAAAAAAAAAull, 0xCCCCCCCCCCCCCCCCull, 0xF0F0F0F0F0F0F0F0ull,
+                                                 0xFF00FF00FF00FF00ull, 0xFFFF0000FFFF0000ull, 0xFFFFFFFF00000000ull};
+
+    int fd_ = -1;
+    std::ostream *stream_ = nullptr;
+    TruthTableFormat format_;
+    std::string buffer_;
+    std::string row_;                 // text and CSV row template
+    std::vector<uint64_t> stack_;
+
+    // the expression is valid: every operator has its operands
+    uint64_t eval_block(const std::string &expression, const uint64_t *columns) {
+        stack_.clear();
+        for (char c : expression) {
+            if (c >= 'A' && c <= 'Z') {
+                stack_.push_back(columns[c - 'A']);
+            } else if (c == '!') {
+                stack_.back() = ~stack_.back();
+            } else {
+                uint64_t b = stack_.back(); stack_.pop_back();
+                uint64_t &a = stack_.back();
+                switch (c) {
+                    case '&': a &= b; break;
+                    case '|': a |= b; break;
+                    case '^': a ^= b; break;
+                    case '>': a = ~a | b; break;
+                    case '=': a = ~(a ^ b); break;
+                }
+            }
+        }
+        return stack_.back();
+    }
+
+    void header(uint32_t variables, int n) {
+        if (format_ != TRUTH_TABLE_TEXT && format_ != TRUTH_TABLE_CSV) return;
+        const char *separator = format_ == TRUTH_TABLE_TEXT ? " | " : ",";
+        for (int v = 0; v < 26; ++v) {
+            if (!((variables >> v) & 1)) continue;
+            buffer_ += static_cast<char>('A' + v);
+            buffer_ += separator;
+        }
+        buffer_ += "Result\n";
+
+        // a row of zeros; each row overwrites the digits
+        row_.clear();
+        for (int j = 0; j < n; ++j) {
+            row_ += '0';
+            row_ += separator;
+        }
+        row_ += "0\n";
+    }
+
+    void emit_block(uint64_t results, uint64_t base, uint64_t count, int n) {
+        switch (format_) {
+            case TRUTH_TABLE_TEXT:
+            case TRUTH_TABLE_CSV: {
+                size_t stride = format_ == TRUTH_TABLE_TEXT ? 4 : 2;
+                for (uint64_t i = 0; i < count; ++i) {
+                    uint64_t row = base + i;
+                    for (int j = 0; j < n; ++j) row_[j * stride] = static_cast<char>('0' + ((row >> (n - 1 - j)) & 1));
+                    row_[n * stride] = static_cast<char>('0' + ((results >> i) & 1));
+                    buffer_ += row_;
+                }
+                break;
+            }
+            case TRUTH_TABLE_BINARY:
+                for (uint64_t byte = 0; byte < (count + 7) / 8; ++byte) {
+                    uint64_t bits = results >> (8 * byte);
+                    if (count < 8) bits &= (uint64_t(1) << count) - 1;
+                    buffer_ += static_cast<char>(bits & 0xFF);
+                }
+                break;
+            case TRUTH_TABLE_MINTERMS:
+                if (count < 64) results &= (uint64_t(1) << count) - 1;
+                for (; results; results &= results - 1) {
+                    char digits[24];
+                    auto end = std::to_chars(digits, digits + sizeof(digits), base + __builtin_ctzll(results)).ptr;
+                    buffer_.append(digits, end);
+                    buffer_ += '\n';
+                }
+                break;
+        }
+    }
+};
+
+inline void write_truth_table(int fd, const std::string &expression, TruthTableFormat format = TRUTH_TABLE_TEXT) {
+    TruthTableWriter writer(fd, format);
+    writer.write(expression);
+    writer.flush();
+}
+
+// Rows written before a limit trips stay written
+inline LimitStatus write_truth_table(int fd, const std::string &expression, TruthTableFormat format,
+                                     const ResourceLimits &limits) {
+    return run_with_limits<bool>(limits, [&] { write_truth_table(fd, expression, format); return true; }).status;
+}
+
+inline void print_truth_table(const std::string &expression) {
+    TruthTableWriter writer(std::cout);
+    writer.write(expression);
+    writer.flush();
+}
+
+// Rows printed before a limit trips stay printed
+inline LimitStatus print_truth_table(const std::string &expression, const ResourceLimits &limits) {
+    return run_with_limits<bool>(limits, [&] { print_truth_table(expression); return true; }).status;
+}
+
+// Normalization instrumentation
+//
+// Built with -DBOOLEAN_ALGEBRA_INSTRUMENT, negation_normal_form and
+// conjunctive_normal_form record, per call and per thread, the AST size after
+// each stage, clone_node calls, simplifier rewrites, distribution steps, the
+// peak number of live AST nodes and the wall time of each stage. Without the
+// flag the hooks compile to nothing and the counters stay at zero.
+
+struct NormalizationCounters {
+    uint64_t parse_nodes = 0;           // AST size after parsing
+    uint64_t eliminate_nodes = 0;       // after eliminate_complex_operators
+    uint64_t nnf_nodes = 0;             // after convert_to_nnf
+    uint64_t cnf_nodes = 0;             // after convert_to_cnf (CNF only)
+    uint64_t clone_calls = 0;
+    uint64_t simplifications = 0;       // rewrites by the smart constructors
+    uint64_t distribution_steps = 0;    // distribute_or_over_and calls
+    uint64_t peak_nodes = 0;            // most AST nodes alive at once
+    double parse_seconds = 0;
+    double eliminate_seconds = 0;
+    double nnf_seconds = 0;
+    double cnf_seconds = 0;
+    double emit_seconds = 0;            // ast_to_rpn
+
+    // sums every counter, keeping the larger peak
+    void add(const NormalizationCounters &other) {
+        parse_nodes += other.parse_nodes;
+        eliminate_nodes += other.eliminate_nodes;
+        nnf_nodes += other.nnf_nodes;
+        cnf_nodes += other.cnf_nodes;
+        clone_calls += other.clone_calls;
+        simplifications += other.simplifications;
+        distribution_steps += other.distribution_steps;
+        peak_nodes = std::max(peak_nodes, other.peak_nodes);
+        parse_seconds += other.parse_seconds;
+        eliminate_seconds += other.eliminate_seconds;
+        nnf_seconds += other.nnf_seconds;
+        cnf_seconds += other.cnf_seconds;
+        emit_seconds += other.emit_seconds;
+    }
+};
+
+struct NormalizationStats {
+    uint64_t calls = 0;
+    NormalizationCounters last;         // the most recent call
+    NormalizationCounters total;        // every call since the last reset
+};
+
+#ifdef BOOLEAN_ALGEBRA_INSTRUMENT
+constexpr bool normalization_instrumented = true;
+#else
+constexpr bool normalization_instrumented = false;
+#endif
+
+inline thread_local NormalizationStats normalization_stats_state;
+
+// counters of the calling thread
+inline const NormalizationStats &normalization_stats() {
+    return normalization_stats_state;
+}
+
+inline void reset_normalization_stats() {
+    normalization_stats_state = NormalizationStats{};
+}
+
+// Prometheus text exposition of the cumulative counters
+inline std::string normalization_stats_prometheus(const NormalizationStats &stats = normalization_stats()) {
+    const NormalizationCounters &t = stats.total;
+    std::ostringstream out;
+
+    auto metric = [&](const char *name, const char *type, const char *help) {
+        out << "# HELP boolean_algebra_" << name << ' ' << help << '\n';
+        out << "# TYPE boolean_algebra_" << name << ' ' << type << '\n';
+    };
+    auto staged = [&](const char *name, const char *stage, auto value) {
+        out << "boolean_algebra_" << name << "{stage=\"" << stage << "\"} " << value << '\n';
+    };
+
+    metric("normalization_calls_total", "counter", "Calls to negation_normal_form and conjunctive_normal_form.");
+    out << "boolean_algebra_normalization_calls_total " << stats.calls << '\n';
+
+    metric("normalization_nodes_total", "counter", "AST nodes present after each stage.");
+    staged("normalization_nodes_total", "parse", t.parse_nodes);
+    staged("normalization_nodes_total", "eliminate", t.eliminate_nodes);
+    staged("normalization_nodes_total", "nnf", t.nnf_nodes);
+    staged("normalization_nodes_total", "cnf", t.cnf_nodes);
+
+    metric("normalization_seconds_total", "counter", "Wall time spent in each stage.");
+    staged("normalization_seconds_total", "parse", t.parse_seconds);
+    staged("normalization_seconds_total", "eliminate", t.eliminate_seconds);
+    staged("normalization_seconds_total", "nnf", t.nnf_seconds);
+    staged("normalization_seconds_total", "cnf", t.cnf_seconds);
+    staged("normalization_seconds_total", "emit", t.emit_seconds);
+
+    metric("normalization_clone_calls_total", "counter", "clone_node calls, recursive ones included.");
+    out << "boolean_algebra_normalization_clone_calls_total " << t.clone_calls << '\n';
+
+    metric("normalization_simplifications_total", "counter", "Rewrites applied while building the AST.");
+    out << "boolean_algebra_normalization_simplifications_total " << t.simplifications << '\n';
+
+    metric("normalization_distribution_steps_total", "counter", "distribute_or_over_and calls.");
+    out << "boolean_algebra_normalization_distribution_steps_total " << t.distribution_steps << '\n';
+
+    metric("normalization_peak_nodes", "gauge", "Most AST nodes alive at once during a single call.");
+    out << "boolean_algebra_normalization_peak_nodes " << t.peak_nodes << '\n';
+
+    return out.str();
+}
+
+#ifdef BOOLEAN_ALGEBRA_INSTRUMENT
+
+struct NNFNode;
+inline uint64_t count_ast_nodes(const NNFNode *node);
+
+// One normalization call: stage() closes the stage started by the previous
+// mark, the destructor folds the call into the cumulative counters.
+class NormalizationTrace {
+public:
+    NormalizationTrace() {
+        normalization_stats_state.last = NormalizationCounters{};
+        // nodes alive before the call (other ASTs of this thread) don't count
+        base_nodes_ = ast_live_nodes;
+        normalization_stats_state.last.peak_nodes = 0;
+        mark_ = std::chrono::steady_clock::now();
+    }
+
+    ~NormalizationTrace() {
+        NormalizationCounters &last = normalization_stats_state.last;
+        last.peak_nodes -= std::min(last.peak_nodes, base_nodes_);
+        normalization_stats_state.total.add(last);
+        ++normalization_stats_state.calls;
+    }
+
+    NormalizationTrace(const NormalizationTrace &) = delete;
+    NormalizationTrace &operator=(const NormalizationTrace &) = delete;
+
+    void stage(uint64_t NormalizationCounters::*nodes, double NormalizationCounters::*seconds,
+               const NNFNode *ast) {
+        auto now = std::chrono::steady_clock::now();
+        normalization_stats_state.last.*seconds += std::chrono::duration<double>(now - mark_).count();
+        if (nodes) normalization_stats_state.last.*nodes = count_ast_nodes(ast);
+        // node counting is not part of the next stage
+        mark_ = std::chrono::steady_clock::now();
+    }
+
+private:
+    uint64_t base_nodes_ = 0;
+    std::chrono::steady_clock::time_point mark_;
+};
+
+#define NORMALIZATION_TRACE(trace) NormalizationTrace trace
+#define NORMALIZATION_STAGE(trace, name, ast) \
+    trace.stage(&NormalizationCounters::name##_nodes, &NormalizationCounters::name##_seconds, (ast))
+#define NORMALIZATION_EMIT(trace) trace.stage(nullptr, &NormalizationCounters::emit_seconds, nullptr)
+#define NORMALIZATION_COUNT(field) (++normalization_stats_state.last.field)
+
+#else
+
+#define NORMALIZATION_TRACE(trace) ((void)0)
+#define NORMALIZATION_STAGE(trace, name, ast) ((void)0)
+#define NORMALIZATION_EMIT(trace) ((void)0)
+#define NORMALIZATION_COUNT(field) ((void)0)
+
+#endif
+
+// ex05
+struct NNFNode;
+
+// Operands of an NNFNode, in order. Up to two are stored inline, which
+// covers NOT, ^, > and = and most AND/OR nodes without an allocation; a
+// longer AND/OR moves them to a heap array, whose bytes count against
+// max_memory_bytes along with the nodes.
+class NNFOperands {
+public:
+    using value_type = std::unique_ptr<NNFNode>;
+    using iterator = value_type *;
+    using const_iterator = const value_type *;
+
+    NNFOperands() = default;
+    NNFOperands(NNFOperands &&other) noexcept { take(other); }
+    NNFOperands &operator=(NNFOperands &&other) noexcept;
+    ~NNFOperands() { release(); }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    value_type *data() { return heap_ ? heap_.get() : inline_; }
+    const value_type *data() const { return heap_ ? heap_.get() : inline_; }
+    iterator begin() { return data(); }
+    iterator end() { return data() + size_; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + size_; }
+    value_type &operator[](size_t i) { return data()[i]; }
+    const value_type &operator[](size_t i) const { return data()[i]; }
+
+    void reserve(size_t capacity) {
+        if (capacity > capacity_) grow(capacity);
+    }
+    void push_back(value_type operand) {
+        if (size_ == capacity_) grow(2 * capacity_);
+        data()[size_++] = std::move(operand);
+    }
+    iterator erase(iterator position);
+
+private:
+    static constexpr uint32_t kInline = 2;
+
+    void grow(size_t capacity);
+    void take(NNFOperands &other) noexcept;
+    void release() noexcept;
+
+    value_type inline_[kInline];
+    std::unique_ptr<value_type[]> heap_;
+    uint32_t size_ = 0;
+    uint32_t capacity_ = kInline;
+};
 
-	for (const char o : operands) {
-		if (c == o) { return (true); }
-	}
+struct NNFNode {
+    enum Type { VARIABLE, AND, OR, NOT, XOR, IMPLIES, EQUIV, CONST };
+    Type type;
+    char variable;                      // the letter, or '0'/'1' for CONST
+    // One operand for NOT, two for XOR, IMPLIES and EQUIV, two or more for
+    // AND and OR. Chains are flattened as the tree is built, so an AND never
+    // has an AND operand, nor an OR an OR one.
+    NNFOperands operands;
 
-	return (false);
+    NNFNode(char var) : type(VARIABLE), variable(var) { ast_node_created(); }
+    NNFNode(Type op) : type(op) { ast_node_created(); }
+    ~NNFNode() { --ast_live_nodes; }
+
+    static void ast_node_created();
+};
+
+// Bytes held by the AST of the limited call: its nodes and the operand
+// arrays that outgrew a node
+inline uint64_t limit_ast_bytes(const ActiveLimits &active) {
+    uint64_t operand_bytes = ast_operand_bytes - std::min(ast_operand_bytes, active.base_operand_bytes);
+    return (ast_live_nodes - active.base_nodes) * sizeof(NNFNode) + operand_bytes;
 }
 
-bool eval_formula(const std::string &expression) {
-    std::stack<bool> data;
-    
-    for (char c : expression) {
-        if (c == '0' || c == '1') {
-            data.push(c == '1');
-        } else if (c == '!') {
-            if (data.empty()) {
-                throw std::invalid_argument("Error: Invalid RPN expression: not enough operands");
-            }
-            bool operand = data.top(); 
-            data.pop();
-            data.push(!operand);
-        } else if (check_operand(c)) {
-            if (data.size() < 2) {
-                throw std::invalid_argument("Error: Invalid RPN expression: not enough operands");
-            }
-            bool b = data.top(); data.pop();
-            bool a = data.top(); data.pop();
-            bool result = process_operand(a, b, c);
-            data.push(result);
-        } else {
-            throw std::invalid_argument("Error: Invalid RPN expression: bad operand");
-        }
+// Memory check for `bytes` more on top of the AST: a node, an operand array,
+// or the RPN string built by ast_to_rpn
+inline void limit_charge_memory(size_t bytes) {
+    ActiveLimits *active = active_limits;
+    if (!active || !active->limits->max_memory_bytes) return;
+    if (limit_ast_bytes(*active) + bytes > active->limits->max_memory_bytes) {
+        throw ResourceLimitExceeded(LIMIT_MEMORY);
     }
+}
 
-    if (data.size() != 1) {
-        throw std::invalid_argument("Error: Invalid RPN expression: bad construction");
+// Checked before the count is taken: a node whose constructor throws never
+// reaches its destructor
+inline void NNFNode::ast_node_created() {
+    uint64_t live = ast_live_nodes + 1;
+    if (ActiveLimits *active = active_limits) {
+        const ResourceLimits &limits = *active->limits;
+        if (limits.max_nodes && live - active->base_nodes > limits.max_nodes) throw ResourceLimitExceeded(LIMIT_NODES);
+        limit_charge_memory(sizeof(NNFNode));
+        limit_poll();
     }
-    
-    return data.top();
+    ast_live_nodes = live;
+#ifdef BOOLEAN_ALGEBRA_INSTRUMENT
+    uint64_t &peak = normalization_stats_state.last.peak_nodes;
+    peak = std::max(peak, live);
+#endif
 }
 
-// ex04
-void print_truth_table(const std::string &expression) {
-	std::set<char> variables;
+inline NNFOperands &NNFOperands::operator=(NNFOperands &&other) noexcept {
+    if (this != &other) {
+        release();
+        take(other);
+    }
+    return *this;
+}
 
-	for (const char c : expression) {
-		if (c >= 'A' && c <= 'Z') {
-			variables.insert(c);
-		} else if (c == '1' || c == '0') {
-			throw std::invalid_argument("Error: invalid expression for truth table: only A-Z characters and valid operators admitted");
-		}
-	}
+inline void NNFOperands::release() noexcept {
+    for (value_type &operand : *this) operand.reset();
+    if (heap_) {
+        ast_operand_bytes -= capacity_ * sizeof(value_type);
+        heap_.reset();
+    }
+    size_ = 0;
+    capacity_ = kInline;
+}
 
-	std::vector<char> vars(variables.begin(), variables.end());
-	int n = vars.size();
+inline NNFOperands::iterator NNFOperands::erase(iterator position) {
+    std::move(position + 1, end(), position);
+    data()[--size_].reset();
+    return position;
+}
 
-	for (char var : vars) {
-		std::cout << var << " | ";
-	}
-		std::cout << "Result" << std::endl;
+// Charged before allocating, so a limit stops the growth with the
+// operands untouched
+inline void NNFOperands::grow(size_t capacity) {
+    if (capacity > UINT32_MAX) throw std::length_error("Error: too many operands");
+    limit_charge_memory(capacity * sizeof(value_type));
+    std::unique_ptr<value_type[]> grown(new value_type[capacity]);
+    std::move(begin(), end(), grown.get());
+    if (heap_) ast_operand_bytes -= capacity_ * sizeof(value_type);
+    ast_operand_bytes += capacity * sizeof(value_type);
+    heap_ = std::move(grown);
+    capacity_ = static_cast<uint32_t>(capacity);
+}
 
-		for (int i = 0; i < (1 << n); ++i) {
-		std::string sub = expression;
-		std::vector<bool> values(n);
-		
-		for (int j = 0; j < n; ++j) {
-			values[j] = (i >> (n - 1 - j)) & 1;
-			char value = values[j] ? '1' : '0';
-			std::replace(sub.begin(), sub.end(), vars[j], value);
-		}
-		
-		bool result = eval_formula(sub);
-		
-		for (bool val : values) {
-			std::cout << (val ? 1 : 0) << " | ";
-		}
-		std::cout << (result ? 1 : 0) << std::endl;
-	}
+inline void NNFOperands::take(NNFOperands &other) noexcept {
+    if (other.heap_) {
+        heap_ = std::move(other.heap_);
+        capacity_ = other.capacity_;
+    } else {
+        std::move(other.inline_, other.inline_ + other.size_, inline_);
+    }
+    size_ = other.size_;
+    other.size_ = 0;
+    other.capacity_ = kInline;
 }
 
-// ex05
-struct NNFNode {
-    enum Type { VARIABLE, AND, OR, NOT, XOR, IMPLIES, EQUIV };
-    Type type;
-    char variable;
-    std::unique_ptr<NNFNode> left;
-    std::unique_ptr<NNFNode> right;
-    
-    NNFNode(char var) : type(VARIABLE), variable(var) {}
-    NNFNode(Type op) : type(op) {}
-};
+#ifdef BOOLEAN_ALGEBRA_INSTRUMENT
+inline uint64_t count_ast_nodes(const NNFNode *node) {
+    if (!node) return 0;
+    uint64_t count = 1;
+    for (const auto &operand : node->operands) count += count_ast_nodes(operand.get());
+    return count;
+}
+#endif
+
+// Adds `operand` to the operands of a `type` junction, splicing in its own
+// operands when it is a junction of the same type
+inline void append_operand(NNFNode::Type type, NNFOperands &operands, std::unique_ptr<NNFNode> operand) {
+    if (operand->type != type) {
+        operands.push_back(std::move(operand));
+        return;
+    }
+    for (auto &inner : operand->operands) operands.push_back(std::move(inner));
+}
 
-std::unique_ptr<NNFNode> push_negation_down(std::unique_ptr<NNFNode> not_node);
+// The operands with each `type` junction among them replaced by its own
+// operands, allocated once at their final size
+inline NNFOperands splice_operands(NNFNode::Type type, NNFOperands &operands) {
+    size_t count = 0;
+    for (const auto &operand : operands) count += operand->type == type ? operand->operands.size() : 1;
+    NNFOperands spliced;
+    spliced.reserve(count);
+    for (auto &operand : operands) append_operand(type, spliced, std::move(operand));
+    return spliced;
+}
+
+inline std::unique_ptr<NNFNode> push_negation_down(std::unique_ptr<NNFNode> not_node);
 
-std::unique_ptr<NNFNode> convert_to_nnf(std::unique_ptr<NNFNode> ast) {
+inline std::unique_ptr<NNFNode> convert_to_nnf(std::unique_ptr<NNFNode> ast) {
     if (!ast) return ast;
     
-    // Base case: variables are already in NNF
-    if (ast->type == NNFNode::VARIABLE) {
+    // Base case: variables and constants are already in NNF
+    if (ast->type == NNFNode::VARIABLE || ast->type == NNFNode::CONST) {
         return ast;
     }
     
@@ -198,10 +1363,17 @@ std::unique_ptr<NNFNode> convert_to_nnf(std::unique_ptr<NNFNode> ast) {
         return push_negation_down(std::move(ast));
     }
     
-    // For AND and OR: recursively convert children
+    // For AND and OR: convert each operand, then splice in those that
+    // became a junction of the same type
     if (ast->type == NNFNode::AND || ast->type == NNFNode::OR) {
-        ast->left = convert_to_nnf(std::move(ast->left));
-        ast->right = convert_to_nnf(std::move(ast->right));
+        bool splice = false;
+        for (auto &operand : ast->operands) {
+            operand = convert_to_nnf(std::move(operand));
+            splice = splice || operand->type == ast->type;
+        }
+        if (splice) {
+            ast->operands = splice_operands(ast->type, ast->operands);
+        }
         return ast;
     }
     
@@ -209,397 +1381,883 @@ std::unique_ptr<NNFNode> convert_to_nnf(std::unique_ptr<NNFNode> ast) {
     throw std::invalid_argument("Unexpected operator in NNF conversion");
 }
 
-std::unique_ptr<NNFNode> push_negation_down(std::unique_ptr<NNFNode> not_node) {
-    auto inner = std::move(not_node->right);
+inline std::unique_ptr<NNFNode> push_negation_down(std::unique_ptr<NNFNode> not_node) {
+    auto inner = std::move(not_node->operands[0]);
     
     if (inner->type == NNFNode::NOT) {
         // Double negation: !!A -> A
-        return convert_to_nnf(std::move(inner->right));
+        return convert_to_nnf(std::move(inner->operands[0]));
     }
     
     if (inner->type == NNFNode::VARIABLE) {
         // Variable negation: !A -> !A (already NNF)
-        not_node->right = std::move(inner);
+        not_node->operands[0] = std::move(inner);
         return not_node;
     }
     
-    if (inner->type == NNFNode::AND) {
-        // De Morgan: !(A & B) -> !A | !B
-        auto left_neg = std::make_unique<NNFNode>(NNFNode::NOT);
-        left_neg->right = std::move(inner->left);
-        
-        auto right_neg = std::make_unique<NNFNode>(NNFNode::NOT);
-        right_neg->right = std::move(inner->right);
-        
-        auto or_node = std::make_unique<NNFNode>(NNFNode::OR);
-        or_node->left = convert_to_nnf(std::move(left_neg));
-        or_node->right = convert_to_nnf(std::move(right_neg));
-        
-        return or_node;
-    }
-    
-    if (inner->type == NNFNode::OR) {
-        // De Morgan: !(A | B) -> !A & !B
-        auto left_neg = std::make_unique<NNFNode>(NNFNode::NOT);
-        left_neg->right = std::move(inner->left);
+    if (inner->type == NNFNode::AND || inner->type == NNFNode::OR) {
+        // De Morgan: !(A & B & ...) -> !A | !B | ..., !(A | B | ...) -> !A & !B & ...
+        auto dual = std::make_unique<NNFNode>(inner->type == NNFNode::AND ? NNFNode::OR : NNFNode::AND);
+        dual->operands.reserve(inner->operands.size());
         
-        auto right_neg = std::make_unique<NNFNode>(NNFNode::NOT);
-        right_neg->right = std::move(inner->right);
-        
-        auto and_node = std::make_unique<NNFNode>(NNFNode::AND);
-        and_node->left = convert_to_nnf(std::move(left_neg));
-        and_node->right = convert_to_nnf(std::move(right_neg));
+        for (auto &operand : inner->operands) {
+            auto negated = std::make_unique<NNFNode>(NNFNode::NOT);
+            negated->operands.push_back(std::move(operand));
+            append_operand(dual->type, dual->operands, convert_to_nnf(std::move(negated)));
+        }
         
-        return and_node;
+        return dual;
     }
     
     throw std::invalid_argument("Unexpected node type in negation");
 }
 
-std::unique_ptr<NNFNode> clone_node(const NNFNode* node) {
+inline std::unique_ptr<NNFNode> clone_node(const NNFNode* node) {
 	if (!node) return nullptr;
+	NORMALIZATION_COUNT(clone_calls);
 	
 	if (node->type == NNFNode::VARIABLE) {
 		return std::make_unique<NNFNode>(node->variable);
 	}
 	
 	auto cloned = std::make_unique<NNFNode>(node->type);
-	if (node->left) cloned->left = clone_node(node->left.get());
-	if (node->right) cloned->right = clone_node(node->right.get());
+	if (node->type == NNFNode::CONST) cloned->variable = node->variable;
+	cloned->operands.reserve(node->operands.size());
+	for (const auto &operand : node->operands) {
+		cloned->operands.push_back(clone_node(operand.get()));
+	}
 	
 	return cloned;
 }
 
-std::unique_ptr<NNFNode> eliminate_complex_operators(std::unique_ptr<NNFNode> ast) {
+// Smart constructors
+//
+// parse_rpn_to_ast and eliminate_complex_operators create every operator node
+// through these, so the tree is simplified bottom-up as it is built:
+// constants propagate, !!A is A, A & A and A | A are A, A & !A is 0, A | !A
+// is 1, A & (A | B) and A | (A & B) are A, and ^, > and = fold when their
+// operands are equal or complementary. A constant is left only when the whole
+// formula folds to one. Operands are compared structurally over at most
+// kSimplifyCompareNodes nodes, and a new AND/OR operand only against the last
+// kSimplifyCompareOperands already there; past either they count as
+// different and the rewrite is skipped, which keeps construction linear.
+
+constexpr int kSimplifyCompareNodes = 64;
+constexpr size_t kSimplifyCompareOperands = 16;
+
+inline bool same_subtree(const NNFNode *a, const NNFNode *b, int &budget) {
+    if (a->type != b->type || a->operands.size() != b->operands.size() || --budget < 0) return false;
+    if (a->type == NNFNode::VARIABLE || a->type == NNFNode::CONST) return a->variable == b->variable;
+    for (size_t i = 0; i < a->operands.size(); ++i) {
+        if (!same_subtree(a->operands[i].get(), b->operands[i].get(), budget)) return false;
+    }
+    return true;
+}
+
+inline bool same_subtree(const NNFNode *a, const NNFNode *b) {
+    int budget = kSimplifyCompareNodes;
+    return same_subtree(a, b, budget);
+}
+
+// a is !b or b is !a
+inline bool complementary(const NNFNode *a, const NNFNode *b) {
+    return (a->type == NNFNode::NOT && same_subtree(a->operands[0].get(), b)) ||
+           (b->type == NNFNode::NOT && same_subtree(b->operands[0].get(), a));
+}
+
+// some operand of `junction` is `node`
+inline bool has_operand(const NNFNode *junction, const NNFNode *node) {
+    for (const auto &operand : junction->operands) {
+        if (same_subtree(operand.get(), node)) return true;
+    }
+    return false;
+}
+
+inline bool is_constant(const NNFNode *node, bool value) {
+    return node->type == NNFNode::CONST && node->variable == (value ? '1' : '0');
+}
+
+inline std::unique_ptr<NNFNode> make_constant(bool value) {
+    auto node = std::make_unique<NNFNode>(NNFNode::CONST);
+    node->variable = value ? '1' : '0';
+    return node;
+}
+
+inline std::unique_ptr<NNFNode> simplified(std::unique_ptr<NNFNode> node) {
+    NORMALIZATION_COUNT(simplifications);
+    return node;
+}
+
+inline std::unique_ptr<NNFNode> make_not(std::unique_ptr<NNFNode> operand) {
+    if (operand->type == NNFNode::CONST) return simplified(make_constant(operand->variable == '0'));
+    if (operand->type == NNFNode::NOT) return simplified(std::move(operand->operands[0]));
+
+    auto node = std::make_unique<NNFNode>(NNFNode::NOT);
+    node->operands.push_back(std::move(operand));
+    return node;
+}
+
+// Adds one operand to an AND or OR under construction. Returns false when
+// the operand complements one already there, which decides the junction.
+inline bool add_junction_operand(NNFNode &junction, std::unique_ptr<NNFNode> operand) {
+    NNFNode::Type dual = junction.type == NNFNode::AND ? NNFNode::OR : NNFNode::AND;
+    NNFOperands &operands = junction.operands;
+
+    size_t first = operands.size() - std::min(operands.size(), kSimplifyCompareOperands);
+    for (size_t i = first; i < operands.size(); ++i) {
+        const NNFNode *existing = operands[i].get();
+        // idempotence, and absorption of the new operand: A & (A | B) = A
+        if (same_subtree(existing, operand.get()) || (operand->type == dual && has_operand(operand.get(), existing))) {
+            NORMALIZATION_COUNT(simplifications);
+            return true;
+        }
+        if (complementary(existing, operand.get())) {
+            NORMALIZATION_COUNT(simplifications);
+            return false;
+        }
+        // absorption of an existing operand: (A | B) & A = A
+        if (existing->type == dual && has_operand(existing, operand.get())) {
+            NORMALIZATION_COUNT(simplifications);
+            operands.erase(operands.begin() + i);
+            --i;
+        }
+    }
+    operands.push_back(std::move(operand));
+    return true;
+}
+
+// AND or OR: `unit` is the constant that drops out (1 for AND, 0 for OR), its
+// complement the one that decides the junction. A left operand that already
+// is a junction of this type is extended in place, so a chain costs one
+// append per link.
+inline std::unique_ptr<NNFNode> make_junction(NNFNode::Type type, std::unique_ptr<NNFNode> left,
+                                              std::unique_ptr<NNFNode> right) {
+    bool unit = type == NNFNode::AND;
+
+    if (is_constant(left.get(), unit) || is_constant(right.get(), !unit)) return simplified(std::move(right));
+    if (is_constant(right.get(), unit) || is_constant(left.get(), !unit)) return simplified(std::move(left));
+
+    if (left->type != type && right->type != type) {
+        // two plain operands: the checks of add_junction_operand, in the
+        // same order, before a node is allocated
+        NNFNode::Type dual = unit ? NNFNode::OR : NNFNode::AND;
+        if (same_subtree(left.get(), right.get()) || (right->type == dual && has_operand(right.get(), left.get()))) {
+            return simplified(std::move(left));
+        }
+        if (complementary(left.get(), right.get())) return simplified(make_constant(!unit));
+        if (left->type == dual && has_operand(left.get(), right.get())) return simplified(std::move(right));
+
+        auto node = std::make_unique<NNFNode>(type);
+        node->operands.push_back(std::move(left));
+        node->operands.push_back(std::move(right));
+        return node;
+    }
+
+    std::unique_ptr<NNFNode> node;
+    if (left->type == type) {
+        node = std::move(left);
+    } else {
+        node = std::make_unique<NNFNode>(type);
+        node->operands.push_back(std::move(left));
+    }
+
+    bool decided = false;
+    if (right->type == type) {
+        for (auto &operand : right->operands) {
+            if (!add_junction_operand(*node, std::move(operand))) decided = true;
+            if (decided) break;
+        }
+    } else {
+        decided = !add_junction_operand(*node, std::move(right));
+    }
+    if (decided) return make_constant(!unit);
+
+    if (node->operands.size() == 1) return std::move(node->operands[0]);
+    return node;
+}
+
+// XOR, IMPLIES or EQUIV
+inline std::unique_ptr<NNFNode> make_connective(NNFNode::Type type, std::unique_ptr<NNFNode> left,
+                                                std::unique_ptr<NNFNode> right) {
+    bool left_constant = left->type == NNFNode::CONST;
+    bool right_constant = right->type == NNFNode::CONST;
+
+    if (type == NNFNode::IMPLIES) {
+        // 0 > B = 1, 1 > B = B, A > 1 = 1, A > 0 = !A
+        if (is_constant(left.get(), false) || is_constant(right.get(), true)) return simplified(make_constant(true));
+        if (left_constant) return simplified(std::move(right));
+        if (right_constant) return simplified(make_not(std::move(left)));
+        if (same_subtree(left.get(), right.get())) return simplified(make_constant(true));
+        // !B > B = B, A > !A = !A
+        if (complementary(left.get(), right.get())) return simplified(std::move(right));
+    } else {
+        // A ^ 0 = A = 1 = A, A ^ 1 = A = 0 = !A
+        bool keeps = type == NNFNode::EQUIV;
+        if (left_constant) std::swap(left, right);
+        if (left_constant || right_constant) {
+            if (is_constant(right.get(), keeps)) return simplified(std::move(left));
+            return simplified(make_not(std::move(left)));
+        }
+        if (same_subtree(left.get(), right.get())) return simplified(make_constant(keeps));
+        if (complementary(left.get(), right.get())) return simplified(make_constant(!keeps));
+    }
+
+    auto node = std::make_unique<NNFNode>(type);
+    node->operands.push_back(std::move(left));
+    node->operands.push_back(std::move(right));
+    return node;
+}
+
+inline std::unique_ptr<NNFNode> make_operator(NNFNode::Type type, std::unique_ptr<NNFNode> left,
+                                              std::unique_ptr<NNFNode> right) {
+    if (type == NNFNode::AND || type == NNFNode::OR) return make_junction(type, std::move(left), std::move(right));
+    return make_connective(type, std::move(left), std::move(right));
+}
+
+inline std::unique_ptr<NNFNode> eliminate_complex_operators(std::unique_ptr<NNFNode> ast) {
 	if (!ast) return ast;
-	if (ast->type == NNFNode::VARIABLE) return ast;
+	if (ast->type == NNFNode::VARIABLE || ast->type == NNFNode::CONST) return ast;
+
+	// Recursively transform operands FIRST
+	bool changed = false;
+	for (auto &operand : ast->operands) {
+		NNFNode::Type before = operand->type;
+		operand = eliminate_complex_operators(std::move(operand));
+		changed = changed || operand->type != before;
+	}
 
-	// Recursively transform children FIRST
-	if (ast->left) {
-		ast->left = eliminate_complex_operators(std::move(ast->left));
+	if (ast->type == NNFNode::AND || ast->type == NNFNode::OR) {
+		if (!changed) return ast;
+
+		// an expanded operand may be a junction of this type, or simplify
+		// against the others: join them again
+		auto joined = std::move(ast->operands[0]);
+		for (size_t i = 1; i < ast->operands.size(); ++i) {
+			joined = make_junction(ast->type, std::move(joined), std::move(ast->operands[i]));
+		}
+		return joined;
 	}
-	if (ast->right) {
-		ast->right = eliminate_complex_operators(std::move(ast->right));
+
+	if (ast->type == NNFNode::NOT) {
+		// only an operand that became a negation or a constant folds with it
+		NNFNode::Type inner = ast->operands[0]->type;
+		if (inner != NNFNode::NOT && inner != NNFNode::CONST) return ast;
+		return make_not(std::move(ast->operands[0]));
 	}
 
+	auto &left = ast->operands[0];
+	auto &right = ast->operands[1];
+
 	if (ast->type == NNFNode::IMPLIES) {
 		// A > B becomes !A | B
-		auto not_left = std::make_unique<NNFNode>(NNFNode::NOT);
-		not_left->right = std::move(ast->left);
-		
-		auto or_node = std::make_unique<NNFNode>(NNFNode::OR);
-		or_node->left = std::move(not_left);
-		or_node->right = std::move(ast->right);
-		
-		return or_node;
+		auto not_left = make_not(std::move(left));
+		return make_junction(NNFNode::OR, std::move(not_left), std::move(right));
 	}
 
 	if (ast->type == NNFNode::EQUIV) {
 		// A = B becomes (A & B) | (!A & !B)
-		auto left_clone = clone_node(ast->left.get());
-		auto right_clone = clone_node(ast->right.get());
-		
-		auto not_left = std::make_unique<NNFNode>(NNFNode::NOT);
-		not_left->right = std::move(left_clone);
-		
-		auto not_right = std::make_unique<NNFNode>(NNFNode::NOT);
-		not_right->right = std::move(right_clone);
+		auto not_left = make_not(clone_node(left.get()));
+		auto not_right = make_not(clone_node(right.get()));
 		
-		// (A & B)
-		auto case1 = std::make_unique<NNFNode>(NNFNode::AND);
-		case1->left = std::move(ast->left);
-		case1->right = std::move(ast->right);
-		
-		// (!A & !B)
-		auto case2 = std::make_unique<NNFNode>(NNFNode::AND);
-		case2->left = std::move(not_left);
-		case2->right = std::move(not_right);
-		
-		// (A & B) | (!A & !B)
-		auto or_node = std::make_unique<NNFNode>(NNFNode::OR);
-		or_node->left = std::move(case1);
-		or_node->right = std::move(case2);
-		
-		return or_node;
+		auto case1 = make_junction(NNFNode::AND, std::move(left), std::move(right));
+		auto case2 = make_junction(NNFNode::AND, std::move(not_left), std::move(not_right));
+		return make_junction(NNFNode::OR, std::move(case1), std::move(case2));
 	}
 	
 	if (ast->type == NNFNode::XOR) {
 		// A ^ B becomes (A & !B) | (!A & B)
-		auto left_clone = clone_node(ast->left.get());
-		auto right_clone = clone_node(ast->right.get());
-		
-		auto not_left = std::make_unique<NNFNode>(NNFNode::NOT);
-		not_left->right = std::move(left_clone);
-		
-		auto not_right = std::make_unique<NNFNode>(NNFNode::NOT);
-		not_right->right = std::move(right_clone);
-		
-		// (A & !B)
-		auto case1 = std::make_unique<NNFNode>(NNFNode::AND);
-		case1->left = std::move(ast->left);
-		case1->right = std::move(not_right);
-		
-		// (!A & B)
-		auto case2 = std::make_unique<NNFNode>(NNFNode::AND);
-		case2->left = std::move(not_left);
-		case2->right = std::move(ast->right);
-		
-		// (A & !B) | (!A & B)
-		auto or_node = std::make_unique<NNFNode>(NNFNode::OR);
-		or_node->left = std::move(case1);
-		or_node->right = std::move(case2);
+		auto not_left = make_not(clone_node(left.get()));
+		auto not_right = make_not(clone_node(right.get()));
 		
-		return or_node;
+		auto case1 = make_junction(NNFNode::AND, std::move(left), std::move(not_right));
+		auto case2 = make_junction(NNFNode::AND, std::move(not_left), std::move(right));
+		return make_junction(NNFNode::OR, std::move(case1), std::move(case2));
 	}
 	
-	// AND, OR, NOT are already basic
-	return ast;
+	throw std::invalid_argument("Unexpected operator in elimination");
 }
 
-std::string ast_to_rpn(const NNFNode* node) {
-    if (!node) return "";
-    
-    if (node->type == NNFNode::VARIABLE) {
-        return std::string(1, node->variable);
+// An AND or OR of n operands is written as its operands followed by n - 1
+// operators: ABC&& for A & B & C
+inline void append_rpn(const NNFNode* node, std::string &out) {
+    if (node->type == NNFNode::VARIABLE || node->type == NNFNode::CONST) {
+        out += node->variable;
+        return;
     }
     
     if (node->type == NNFNode::NOT) {
-        return ast_to_rpn(node->right.get()) + "!";
+        append_rpn(node->operands[0].get(), out);
+        out += '!';
+        return;
     }
     
-    // Binary operators (AND, OR)
-    std::string left_rpn = ast_to_rpn(node->left.get());
-    std::string right_rpn = ast_to_rpn(node->right.get());
-    
     char op;
     if (node->type == NNFNode::AND) op = '&';
     else if (node->type == NNFNode::OR) op = '|';
     else throw std::invalid_argument("Unexpected operator in RPN conversion");
     
-    return left_rpn + right_rpn + op;
+    for (const auto &operand : node->operands) append_rpn(operand.get(), out);
+    out.append(node->operands.size() - 1, op);
+    limit_charge_memory(out.size());
+}
+
+inline std::string ast_to_rpn(const NNFNode* node) {
+    std::string out;
+    if (node) append_rpn(node, out);
+    return out;
 }
 
-std::unique_ptr<NNFNode> parse_rpn_to_ast(const std::string &rpn) {
-	std::stack<std::unique_ptr<NNFNode>> stack;
+// Builds the tree through the smart constructors above, so it comes out
+// already simplified; '0' and '1' are accepted as in eval_formula. A run of
+// one AND or OR operator joins its operands at once, so a conjunction
+// written as clauses followed by &&&... is flattened in linear time.
+inline std::unique_ptr<NNFNode> parse_rpn_to_ast(const std::string &rpn) {
+	std::vector<std::unique_ptr<NNFNode>> stack;
+	stack.reserve(rpn.size());
 
-	for (char c : rpn) {
+	for (size_t i = 0; i < rpn.size(); ++i) {
+		char c = rpn[i];
 		if (c >= 'A' && c <= 'Z') {
-			stack.push(std::make_unique<NNFNode>(c));
+			stack.push_back(std::make_unique<NNFNode>(c));
+		} else if (c == '0' || c == '1') {
+			stack.push_back(make_constant(c == '1'));
 		} else if (c == '!') {
-			 auto operand = std::move(stack.top()) ; stack.pop();
-			 auto node = std::make_unique<NNFNode>(NNFNode::NOT);
-			 node->right = std::move(operand);
-			 stack.push(std::move(node));
+			 if (stack.empty()) {
+				 throw std::invalid_argument("Error: Invalid RPN expression: not enough operands");
+			 }
+			 auto operand = std::move(stack.back()); stack.pop_back();
+			 stack.push_back(make_not(std::move(operand)));
+		} else if (c == '&' || c == '|') {
+			size_t run = 1;
+			while (i + run < rpn.size() && rpn[i + run] == c) ++run;
+			if (stack.size() < run + 1) {
+				throw std::invalid_argument("Error: Invalid RPN expression: not enough operands");
+			}
+
+			NNFNode::Type op_type = c == '&' ? NNFNode::AND : NNFNode::OR;
+			size_t first = stack.size() - run - 1;
+			auto joined = std::move(stack[first]);
+			for (size_t k = first + 1; k < stack.size(); ++k) {
+				joined = make_junction(op_type, std::move(joined), std::move(stack[k]));
+			}
+			stack.resize(first);
+			stack.push_back(std::move(joined));
+			i += run - 1;
 		} else {
-			auto right = std::move(stack.top()); stack.pop();
-			auto left = std::move(stack.top()); stack.pop();
+			if (stack.size() < 2) {
+				throw std::invalid_argument("Error: Invalid RPN expression: not enough operands");
+			}
+			auto right = std::move(stack.back()); stack.pop_back();
+			auto left = std::move(stack.back()); stack.pop_back();
 
 			NNFNode::Type op_type;
-			if (c == '&') op_type = NNFNode::AND;
-			else if (c == '|') op_type = NNFNode::OR;
-			else if (c == '^') op_type = NNFNode::XOR;
+			if (c == '^') op_type = NNFNode::XOR;
 			else if (c == '>') op_type = NNFNode::IMPLIES;
 			else if (c == '=') op_type = NNFNode::EQUIV;
 			else throw std::invalid_argument("Error: Unknown operator");
 
-			auto node = std::make_unique<NNFNode>(op_type);
-			node->left = std::move(left);
-			node->right = std::move(right);
-			stack.push(std::move(node));
+			stack.push_back(make_connective(op_type, std::move(left), std::move(right)));
 		}
 	}
 
-	return (std::move(stack.top()));
+	if (stack.size() != 1) {
+		throw std::invalid_argument("Error: Invalid RPN expression: bad construction");
+	}
+
+	return (std::move(stack.back()));
 }
 
-std::string negation_normal_form(const std::string &rpn) {
+inline std::string negation_normal_form(const std::string &rpn) {
+	NORMALIZATION_TRACE(trace);
 	auto ast = parse_rpn_to_ast(rpn);
+	NORMALIZATION_STAGE(trace, parse, ast.get());
 	ast = eliminate_complex_operators(std::move(ast));
+	NORMALIZATION_STAGE(trace, eliminate, ast.get());
 	ast = convert_to_nnf(std::move(ast));
-	return (ast_to_rpn(ast.get()));
+	NORMALIZATION_STAGE(trace, nnf, ast.get());
+	std::string result = ast_to_rpn(ast.get());
+	NORMALIZATION_EMIT(trace);
+	return (result);
 }
 
-// ex06
-std::unique_ptr<NNFNode> distribute_or_over_and(std::unique_ptr<NNFNode> left, std::unique_ptr<NNFNode> right) {
-    // Handle cases where one side is already a single literal or variable
-    if (left->type != NNFNode::AND && right->type != NNFNode::AND) {
-        // Both are literals, just create OR
-        auto or_node = std::make_unique<NNFNode>(NNFNode::OR);
-        or_node->left = std::move(left);
-        or_node->right = std::move(right);
-        return or_node;
+inline Limited<std::string> negation_normal_form(const std::string &rpn, const ResourceLimits &limits) {
+    return run_with_limits<std::string>(limits, [&] { return negation_normal_form(rpn); });
+}
+
+// Compile-time formulas
+// Fixed-capacity string usable in constant expressions and, from C++20, as a
+// template parameter: fixed_string F = "AB&C|";
+template <size_t Capacity>
+struct fixed_string {
+    char data[Capacity + 1] = {};
+    size_t length = 0;
+
+    constexpr fixed_string() = default;
+    constexpr fixed_string(const char (&str)[Capacity + 1]) {
+        for (size_t i = 0; i < Capacity; ++i) data[i] = str[i];
+        length = Capacity;
     }
-    
-    // If left is AND: (A & B) | C becomes (A | C) & (B | C)
-    if (left->type == NNFNode::AND && right->type != NNFNode::AND) {
-        auto right_clone = clone_node(right.get());
-        
-        auto or1 = distribute_or_over_and(std::move(left->left), std::move(right));
-        auto or2 = distribute_or_over_and(std::move(left->right), std::move(right_clone));
-        
-        auto and_node = std::make_unique<NNFNode>(NNFNode::AND);
-        and_node->left = std::move(or1);
-        and_node->right = std::move(or2);
-        
-        return and_node;
+
+    constexpr std::string_view view() const { return std::string_view(data, length); }
+    constexpr void push_back(char c) {
+        if (length == Capacity) throw std::length_error("Error: fixed_string capacity exceeded");
+        data[length++] = c;
     }
-    
-    // If right is AND: A | (B & C) becomes (A | B) & (A | C)
-    if (right->type == NNFNode::AND && left->type != NNFNode::AND) {
-        auto left_clone = clone_node(left.get());
-        
-        auto or1 = distribute_or_over_and(std::move(left), std::move(right->left));
-        auto or2 = distribute_or_over_and(std::move(left_clone), std::move(right->right));
-        
-        auto and_node = std::make_unique<NNFNode>(NNFNode::AND);
-        and_node->left = std::move(or1);
-        and_node->right = std::move(or2);
-        
-        return and_node;
+    constexpr bool operator==(std::string_view other) const { return view() == other; }
+};
+
+template <size_t N>
+fixed_string(const char (&)[N]) -> fixed_string<N - 1>;
+
+struct FixedNode {
+    char op;
+    int left;
+    int right;
+};
+
+// The junction node `index` (negated when `negated` is set) becomes in NNF:
+// '&' or '|', or 0 for a literal
+constexpr char nnf_junction(const FixedNode *nodes, int index, bool negated) {
+    const FixedNode &node = nodes[index];
+    switch (node.op) {
+        case '!':
+            return nnf_junction(nodes, node.right, !negated);
+        case '&':
+        case '|':
+            return (node.op == '&') != negated ? '&' : '|';
+        case '>':
+        case '=':
+        case '^':
+            return negated ? '&' : '|';
+        default:
+            return 0;
+    }
+}
+
+template <size_t Capacity>
+constexpr void nnf_emit(const FixedNode *nodes, int index, bool negated, fixed_string<Capacity> &out);
+
+template <size_t Capacity>
+constexpr int nnf_emit_operands(const FixedNode *nodes, int index, bool negated, fixed_string<Capacity> &out);
+
+// Emits one operand of a `junction`, splicing in its own operands when it is
+// a junction of the same kind, and returns how many operands that made
+template <size_t Capacity>
+constexpr int nnf_emit_operand(const FixedNode *nodes, int index, bool negated, char junction,
+                               fixed_string<Capacity> &out) {
+    if (nnf_junction(nodes, index, negated) != junction) {
+        nnf_emit(nodes, index, negated, out);
+        return 1;
     }
+    return nnf_emit_operands(nodes, index, negated, out);
+}
+
+// One side of an expanded = or ^: the `junction` of two operands
+template <size_t Capacity>
+constexpr void nnf_emit_pair(const FixedNode *nodes, int left, bool left_negated, int right, bool right_negated,
+                             char junction, fixed_string<Capacity> &out) {
+    int count = nnf_emit_operand(nodes, left, left_negated, junction, out) +
+                nnf_emit_operand(nodes, right, right_negated, junction, out);
+    for (int i = 1; i < count; ++i) out.push_back(junction);
+}
+
+// Emits the operands of a node whose NNF is a junction, returning their count
+template <size_t Capacity>
+constexpr int nnf_emit_operands(const FixedNode *nodes, int index, bool negated, fixed_string<Capacity> &out) {
+    const FixedNode &node = nodes[index];
+    char junction = nnf_junction(nodes, index, negated);
+
+    switch (node.op) {
+        case '!':
+            return nnf_emit_operands(nodes, node.right, !negated, out);
+        case '&':
+        case '|':
+            return nnf_emit_operand(nodes, node.left, negated, junction, out) +
+                   nnf_emit_operand(nodes, node.right, negated, junction, out);
+        case '>':
+            // A > B = !A | B, negated: A & !B
+            return nnf_emit_operand(nodes, node.left, !negated, junction, out) +
+                   nnf_emit_operand(nodes, node.right, negated, junction, out);
+        default: {
+            // A = B = (A & B) | (!A & !B), negated: (!A | !B) & (A | B)
+            // A ^ B = (A & !B) | (!A & B), negated: (!A | B) & (A | !B)
+            bool flip = node.op == '^';
+            char inner = junction == '&' ? '|' : '&';
+            nnf_emit_pair(nodes, node.left, negated, node.right, negated != flip, inner, out);
+            nnf_emit_pair(nodes, node.left, !negated, node.right, negated == flip, inner, out);
+            return 2;
+        }
+    }
+}
+
+// Emits the NNF of node `index` (negated when `negated` is set) without
+// building an intermediate tree: complex operators are expanded as in
+// eliminate_complex_operators, negations are pushed down as in
+// push_negation_down and AND/OR chains are flattened into one operator run.
+// Nothing is simplified, so AA& keeps its repeated operand and A1& its
+// constant; a negated constant is written as the other one.
+template <size_t Capacity>
+constexpr void nnf_emit(const FixedNode *nodes, int index, bool negated, fixed_string<Capacity> &out) {
+    char junction = nnf_junction(nodes, index, negated);
+    if (junction) {
+        int count = nnf_emit_operands(nodes, index, negated, out);
+        for (int i = 1; i < count; ++i) out.push_back(junction);
+        return;
+    }
+
+    while (nodes[index].op == '!') {
+        index = nodes[index].right;
+        negated = !negated;
+    }
+    char leaf = nodes[index].op;
+    if (leaf == '0' || leaf == '1') {
+        out.push_back(negated ? static_cast<char>('0' + '1' - leaf) : leaf);
+        return;
+    }
+    out.push_back(leaf);
+    if (negated) out.push_back('!');
+}
+
+// Index-based tree of an RPN formula built in a constant expression: node i
+// is the formula's i-th symbol, `root` the last one
+template <size_t MaxNodes>
+struct FixedFormula {
+    FixedNode nodes[MaxNodes + 1] = {};
+    int root = 0;
+    uint32_t variables = 0;
+};
+
+template <size_t MaxNodes>
+constexpr FixedFormula<MaxNodes> parse_fixed_rpn(std::string_view rpn, bool allow_constants) {
+    if (rpn.size() > MaxNodes) throw std::length_error("Error: formula exceeds MaxNodes");
+
+    FixedFormula<MaxNodes> formula;
+    int stack[MaxNodes + 1] = {};
+    int depth = 0;
+    int count = 0;
+
+    for (char c : rpn) {
+        FixedNode node = {c, -1, -1};
+        if (c == '!') {
+            if (depth < 1) throw std::invalid_argument("Error: Invalid RPN expression: not enough operands");
+            node.right = stack[--depth];
+        } else if (check_operand(c)) {
+            if (depth < 2) throw std::invalid_argument("Error: Invalid RPN expression: not enough operands");
+            node.right = stack[--depth];
+            node.left = stack[--depth];
+        } else if (c >= 'A' && c <= 'Z') {
+            formula.variables |= uint32_t(1) << (c - 'A');
+        } else if (!(allow_constants && (c == '0' || c == '1'))) {
+            throw std::invalid_argument("Error: Unknown operator");
+        }
+        formula.nodes[count] = node;
+        stack[depth++] = count++;
+    }
+    if (depth != 1) throw std::invalid_argument("Error: Invalid RPN expression: bad construction");
+
+    formula.root = stack[0];
+    return formula;
+}
+
+// Constant-expression NNF, written into a fixed_string of OutCapacity
+// characters, for formulas of up to MaxNodes symbols. The result is an
+// equivalent NNF, unsimplified: it matches negation_normal_form's string only
+// where the smart constructors find nothing to fold. Errors (invalid RPN,
+// output too long) are compile errors when evaluated in a constant
+// expression.
+template <size_t OutCapacity, size_t MaxNodes = OutCapacity>
+constexpr fixed_string<OutCapacity> negation_normal_form_fixed(std::string_view rpn) {
+    FixedFormula<MaxNodes> formula = parse_fixed_rpn<MaxNodes>(rpn, true);
+
+    fixed_string<OutCapacity> out;
+    nnf_emit(formula.nodes, formula.root, false, out);
+    return out;
+}
+
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+// C++20 helpers taking the formula as a template argument:
+//   static_assert(formula_eval<"10|">());
+//   constexpr auto table = formula_truth_table<"AB&C|">();
+//   static_assert(formula_nnf<"AB&!">() == "A!B!|");
+template <fixed_string F>
+constexpr bool formula_eval(uint32_t assignment = 0) {
+    EvalResult result = eval_rpn(F.view(), assignment);
+    if (result.status != EVAL_OK) throw std::invalid_argument("Error: Invalid RPN expression");
+    return result.value;
+}
+
+template <fixed_string F>
+constexpr auto formula_truth_table() {
+    return truth_table<truth_table_words(F.view())>(F.view());
+}
+
+template <fixed_string F, size_t OutCapacity = 8 * (F.length + 1)>
+constexpr auto formula_nnf() {
+    return negation_normal_form_fixed<OutCapacity, F.length>(F.view());
+}
+#endif
+
+// ex06
+// (A & B) | C | (D & E) -> (A | C | D) & (A | C | E) & (B | C | D) & (B | C | E):
+// every way of picking one clause from each conjunctive operand, in order,
+// with the other operands in every clause. Each operand's nodes are moved
+// into their last clause and cloned into the others.
+inline std::unique_ptr<NNFNode> distribute_or_over_and(NNFOperands operands) {
+    NORMALIZATION_COUNT(distribution_steps);
     
-    // Both are AND: (A & B) | (C & D) becomes (A | C) & (A | D) & (B | C) & (B | D)
-    if (left->type == NNFNode::AND && right->type == NNFNode::AND) {
-        auto left_left_clone = clone_node(left->left.get());
-        auto left_right_clone = clone_node(left->right.get());
-        auto right_left_clone = clone_node(right->left.get());
-        auto right_right_clone = clone_node(right->right.get());
-        
-        // (A | C)
-        auto or1 = distribute_or_over_and(std::move(left->left), std::move(right->left));
-        
-        // (A | D)
-        auto or2 = distribute_or_over_and(std::move(left_left_clone), std::move(right->right));
-        
-        // (B | C)
-        auto or3 = distribute_or_over_and(std::move(left->right), std::move(right_left_clone));
-        
-        // (B | D)
-        auto or4 = distribute_or_over_and(std::move(left_right_clone), std::move(right_right_clone));
-        
-        // Build the AND chain: ((A|C) & (A|D)) & ((B|C) & (B|D))
-        auto and1 = std::make_unique<NNFNode>(NNFNode::AND);
-        and1->left = std::move(or1);
-        and1->right = std::move(or2);
-        
-        auto and2 = std::make_unique<NNFNode>(NNFNode::AND);
-        and2->left = std::move(or3);
-        and2->right = std::move(or4);
-        
-        auto final_and = std::make_unique<NNFNode>(NNFNode::AND);
-        final_and->left = std::move(and1);
-        final_and->right = std::move(and2);
+    std::vector<NNFOperands> clauses(1);
+    for (auto &operand : operands) {
+        if (operand->type != NNFNode::AND) {
+            // a literal or a clause joins every clause so far
+            for (size_t i = 0; i < clauses.size(); ++i) {
+                auto copy = i + 1 < clauses.size() ? clone_node(operand.get()) : std::move(operand);
+                append_operand(NNFNode::OR, clauses[i], std::move(copy));
+            }
+            continue;
+        }
         
-        return final_and;
+        NNFOperands &factors = operand->operands;
+        std::vector<NNFOperands> product;
+        product.reserve(clauses.size() * factors.size());
+        for (size_t i = 0; i < clauses.size(); ++i) {
+            for (size_t j = 0; j < factors.size(); ++j) {
+                bool last_factor = j + 1 == factors.size();
+                NNFOperands clause;
+                clause.reserve(clauses[i].size() + 1);
+                for (auto &literal : clauses[i]) {
+                    clause.push_back(last_factor ? std::move(literal) : clone_node(literal.get()));
+                }
+                auto factor = i + 1 < clauses.size() ? clone_node(factors[j].get()) : std::move(factors[j]);
+                append_operand(NNFNode::OR, clause, std::move(factor));
+                product.push_back(std::move(clause));
+            }
+        }
+        clauses = std::move(product);
     }
     
-    // Should not reach here
-    auto or_node = std::make_unique<NNFNode>(NNFNode::OR);
-    or_node->left = std::move(left);
-    or_node->right = std::move(right);
-    return or_node;
+    auto and_node = std::make_unique<NNFNode>(NNFNode::AND);
+    and_node->operands.reserve(clauses.size());
+    for (auto &clause : clauses) {
+        if (clause.size() == 1) {
+            and_node->operands.push_back(std::move(clause[0]));
+            continue;
+        }
+        auto or_node = std::make_unique<NNFNode>(NNFNode::OR);
+        or_node->operands = std::move(clause);
+        and_node->operands.push_back(std::move(or_node));
+    }
+    if (and_node->operands.size() == 1) return std::move(and_node->operands[0]);
+    return and_node;
 }
 
-std::unique_ptr<NNFNode> convert_to_cnf(std::unique_ptr<NNFNode> ast) {
+inline std::unique_ptr<NNFNode> convert_to_cnf(std::unique_ptr<NNFNode> ast) {
     if (!ast) return ast;
     
-    if (ast->type == NNFNode::VARIABLE || 
-        (ast->type == NNFNode::NOT && ast->right->type == NNFNode::VARIABLE)) {
+    if (ast->type == NNFNode::VARIABLE || ast->type == NNFNode::CONST ||
+        (ast->type == NNFNode::NOT && ast->operands[0]->type == NNFNode::VARIABLE)) {
         return ast;
     }
     
-    if (ast->left) {
-        ast->left = convert_to_cnf(std::move(ast->left));
-    }
-    if (ast->right) {
-        ast->right = convert_to_cnf(std::move(ast->right));
+    if (ast->type != NNFNode::AND && ast->type != NNFNode::OR) {
+        // Should not reach here if input is valid NNF
+        throw std::invalid_argument("Unexpected node type in CNF conversion");
     }
     
-    if (ast->type == NNFNode::AND) {
-        return ast;
+    bool has_and = false, splice = false;
+    for (auto &operand : ast->operands) {
+        operand = convert_to_cnf(std::move(operand));
+        has_and = has_and || operand->type == NNFNode::AND;
+        splice = splice || operand->type == ast->type;
     }
     
-    // OR - need to distribute if children contain AND
-    if (ast->type == NNFNode::OR) {
-        return distribute_or_over_and(std::move(ast->left), std::move(ast->right));
+    // OR - need to distribute if operands contain AND
+    if (ast->type == NNFNode::OR && has_and) {
+        return distribute_or_over_and(std::move(ast->operands));
     }
     
-    // Should not reach here if input is valid NNF
-    throw std::invalid_argument("Unexpected node type in CNF conversion");
+    if (splice) {
+        ast->operands = splice_operands(ast->type, ast->operands);
+    }
+    return ast;
 }
 
-std::string conjunctive_normal_form(const std::string &rpn) {
+inline std::string conjunctive_normal_form(const std::string &rpn) {
+    NORMALIZATION_TRACE(trace);
     auto ast = parse_rpn_to_ast(rpn);
+    NORMALIZATION_STAGE(trace, parse, ast.get());
     ast = eliminate_complex_operators(std::move(ast));
+    NORMALIZATION_STAGE(trace, eliminate, ast.get());
     ast = convert_to_nnf(std::move(ast));
+    NORMALIZATION_STAGE(trace, nnf, ast.get());
     
     ast = convert_to_cnf(std::move(ast));
+    NORMALIZATION_STAGE(trace, cnf, ast.get());
     
-    return ast_to_rpn(ast.get());
+    std::string result = ast_to_rpn(ast.get());
+    NORMALIZATION_EMIT(trace);
+    return result;
+}
+
+inline Limited<std::string> conjunctive_normal_form(const std::string &rpn, const ResourceLimits &limits) {
+    return run_with_limits<std::string>(limits, [&] { return conjunctive_normal_form(rpn); });
 }
 
 // ex07
-bool sat(const std::string &formula) {
-    try {
-        std::set<char> variables;
-        for (char c : formula) {
-            if (c >= 'A' && c <= 'Z') {
-                variables.insert(c);
+// Gray-order incremental evaluation
+//
+// GrayEvaluator keeps the value of every node of the formula tree under the
+// current assignment. Flipping a variable flips its leaves and walks up from
+// each of them, recomputing parents until one keeps its value, so a step
+// costs the part of the variable's cone that actually changes rather than
+// the whole formula. Walking the rows in Gray order (gray_code, ex02) makes
+// every step a single flip.
+
+class GrayEvaluator {
+public:
+    explicit GrayEvaluator(const std::string &rpn) {
+        throw_eval_error(eval_rpn_runtime(rpn, 0, true).status);
+
+        std::vector<int32_t> stack;
+        size_t n = rpn.size();
+        op_.reserve(n);
+        left_.reserve(n);
+        right_.reserve(n);
+        parent_.assign(n, -1);
+        value_.reserve(n);
+        for (char c : rpn) {
+            int32_t index = static_cast<int32_t>(op_.size());
+            int32_t a = -1, b = -1;
+            if (c == '!') {
+                a = stack.back();
+                stack.pop_back();
+            } else if (check_operand(c)) {
+                b = stack.back(); stack.pop_back();
+                a = stack.back(); stack.pop_back();
+            } else if (c >= 'A' && c <= 'Z') {
+                occurrences_[c - 'A'].push_back(index);
+                variables_ |= uint32_t(1) << (c - 'A');
             }
+            if (a >= 0) parent_[a] = index;
+            if (b >= 0) parent_[b] = index;
+            op_.push_back(c);
+            left_.push_back(a);
+            right_.push_back(b);
+            value_.push_back(0);
+            value_.back() = compute(index);
+            stack.push_back(index);
         }
-        
-        std::vector<char> vars(variables.begin(), variables.end());
-        int n = vars.size();
-        
-        for (int i = 0; i < (1 << n); ++i) {
-            std::string test_formula = formula;
-            
-            for (int j = 0; j < n; ++j) {
-                bool value = (i >> (n - 1 - j)) & 1;
-                char truth_value = value ? '1' : '0';
-                std::replace(test_formula.begin(), test_formula.end(), vars[j], truth_value);
-            }
-            
-            bool result = eval_formula(test_formula);
-            
-            if (result) {
-                return true;
+    }
+
+    uint32_t variables() const { return variables_; }
+    uint32_t assignment() const { return assignment_; }   // bit v is variable 'A' + v
+    bool value() const { return value_.back(); }
+    uint64_t evaluations() const { return evaluations_; }  // nodes recomputed by flips
+
+    // Toggles variable 'A' + v and returns the formula's new value
+    bool flip(int v) {
+        assignment_ ^= uint32_t(1) << v;
+        for (int32_t leaf : occurrences_[v]) value_[leaf] ^= 1;
+        for (int32_t leaf : occurrences_[v]) {
+            for (int32_t node = parent_[leaf]; node >= 0; node = parent_[node]) {
+                ++evaluations_;
+                uint8_t updated = compute(node);
+                if (updated == value_[node]) break;
+                value_[node] = updated;
             }
         }
-        
-        // No combination made the formula true
-        return false;
-        
+        return value();
+    }
+
+private:
+    std::vector<char> op_;
+    std::vector<int32_t> left_, right_, parent_;
+    std::vector<uint8_t> value_;
+    std::vector<int32_t> occurrences_[26];
+    uint32_t variables_ = 0;
+    uint32_t assignment_ = 0;
+    uint64_t evaluations_ = 0;
+
+    uint8_t compute(int32_t node) const {
+        char c = op_[node];
+        if (c >= 'A' && c <= 'Z') return (assignment_ >> (c - 'A')) & 1;
+        if (c == '0' || c == '1') return c == '1';
+        if (c == '!') return !value_[left_[node]];
+        return process_operand(value_[left_[node]], value_[right_[node]], c);
+    }
+};
+
+// Visits every assignment of the expression's variables in reflected Gray
+// order: step k is truth-table row gray_code(k) (numbered as in
+// print_truth_table), one variable away from step k - 1. visit(row,
+// assignment, value) returns false to stop; the function returns false if it
+// was stopped.
+template <typename Visit>
+bool for_each_gray_assignment(const std::string &expression, Visit &&visit) {
+    GrayEvaluator evaluator(expression);
+    uint32_t variables = evaluator.variables();
+    int n = count_variables(variables);
+
+    // row bit b is the (n - 1 - b)-th variable in alphabetical order
+    int letter_of_bit[26] = {};
+    for (int v = 0, j = 0; v < 26; ++v) {
+        if ((variables >> v) & 1) letter_of_bit[n - 1 - j++] = v;
+    }
+
+    GraySequence rows(n);
+    GrayCursor cursor(rows);
+    GrayStep step;
+    cursor.next(step);
+    if (!visit(step.code, evaluator.assignment(), evaluator.value())) return false;
+    while (cursor.next(step)) {
+        limit_poll();
+        bool value = evaluator.flip(letter_of_bit[step.flipped]);
+        if (!visit(step.code, evaluator.assignment(), value)) return false;
+    }
+    return true;
+}
+
+inline bool sat(const std::string &formula) {
+    try {
+        // stop at the first satisfying row
+        return !for_each_gray_assignment(formula, [](uint64_t, uint32_t, bool value) { return !value; });
+    } catch (const ResourceLimitExceeded &) {
+        throw;
     } catch (const std::exception &e) {
         std::cerr << "Error in SAT evaluation: " << e.what() << std::endl;
         return false;
     }
 }
 
+inline Limited<bool> sat(const std::string &formula, const ResourceLimits &limits) {
+    return run_with_limits<bool>(limits, [&] { return sat(formula); });
+}
+
 // ex08
-std::vector<std::vector<int>> powerset(const std::vector<int> &set) {
-    std::vector<std::vector<int>> result;
+inline std::vector<std::vector<int>> powerset(const std::vector<int> &set) {
     int n = set.size();
-    
-    // Generate all 2^n subsets
-    for (int i = 0; i < (1 << n); ++i) {
-        std::vector<int> subset;
-        
-        for (int j = 0; j < n; ++j) {
-            // If bit j is set in i, include set[j] in the subset
-            if (i & (1 << j)) {
-                subset.push_back(set[j]);
-            }
+    std::vector<std::vector<int>> result(size_t(1) << n);
+
+    // Walk the subsets in Gray order, adding or removing one element per
+    // step; subset i (bit j set for set[j]) still lands at result[i]
+    GraySequence subsets(n);
+    GrayCursor cursor(subsets);
+    GrayStep step;
+    std::vector<int> subset;
+    while (cursor.next(step)) {
+        if (step.flipped >= 0) {
+            uint64_t below = step.code & ((uint64_t(1) << step.flipped) - 1);
+            auto position = subset.begin() + __builtin_popcountll(below);
+            if ((step.code >> step.flipped) & 1) subset.insert(position, set[step.flipped]);
+            else subset.erase(position);
         }
-        
-        result.push_back(subset);
+        result[step.code] = subset;
     }
-    
+
     return result;
 }
 
 // ex09
-std::vector<int> eval_set(const std::string &formula, const std::vector<std::vector<int>> &sets) {
+inline std::vector<int> eval_set(const std::string &formula, const std::vector<std::vector<int>> &sets) {
     std::stack<std::vector<int>> stack;
     
     for (char c : formula) {
@@ -784,7 +2442,7 @@ std::vector<int> eval_set(const std::string &formula, const std::vector<std::vec
 }
 
 // ex10
-double map(uint16_t x, uint16_t y) {
+inline double map(uint16_t x, uint16_t y) {
     uint32_t combined = 0;
     
     for (int i = 0; i < 16; ++i) {
@@ -801,7 +2459,7 @@ double map(uint16_t x, uint16_t y) {
 }
 
 // ex11
-std::pair<uint16_t, uint16_t> reverse_map(double n) {
+inline std::pair<uint16_t, uint16_t> reverse_map(double n) {
     if (n < 0.0) n = 0.0;
     if (n > 1.0) n = 1.0;
     
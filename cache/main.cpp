@@ -0,0 +1,146 @@
+// formula cache main
+
+#include <cassert>
+#include <thread>
+#include "../formula_cache.hpp"
+
+// brute-force equivalence over every assignment of the variables A-Z in use
+bool equivalent(const std::string &f, const std::string &g) {
+    std::set<char> variables;
+    for (char c : f + g) {
+        if (c >= 'A' && c <= 'Z') variables.insert(c);
+    }
+    std::vector<char> vars(variables.begin(), variables.end());
+    int n = vars.size();
+
+    for (int i = 0; i < (1 << n); ++i) {
+        std::string sf = f, sg = g;
+        for (int j = 0; j < n; ++j) {
+            char value = ((i >> j) & 1) ? '1' : '0';
+            std::replace(sf.begin(), sf.end(), vars[j], value);
+            std::replace(sg.begin(), sg.end(), vars[j], value);
+        }
+        if (eval_formula(sf) != eval_formula(sg)) return false;
+    }
+    return true;
+}
+
+void test_canonical_form() {
+    std::cout << "\033[0;33mCanonical Form Tests----------------------\033[0m" << std::endl;
+
+    // renaming
+    assert(canonicalize_formula("AB&").key == canonicalize_formula("XY&").key);
+    // commutative operand order
+    assert(canonicalize_formula("AB!&").key == canonicalize_formula("B!A&").key);
+    assert(canonicalize_formula("AB|C&").key == canonicalize_formula("CBA|&").key);
+    // implication is not commutative
+    assert(canonicalize_formula("AB!>").key != canonicalize_formula("B!A>").key);
+
+    CanonicalFormula canon = canonicalize_formula("QZ!&");
+    std::cout << "QZ!& -> " << canon.key << std::endl;
+    assert(canon.key == "A!B&");
+    assert(canon.to_original[0] == 'Z' && canon.to_original[1] == 'Q');
+
+    // renaming only, for the normal forms
+    CanonicalFormula renamed = rename_formula("C!AB>&");
+    assert(renamed.key == "A!BC>&" && renamed.key == rename_formula("Z!XY>&").key);
+    assert(renamed.to_original[0] == 'C' && renamed.to_canonical['C' - 'A'] == 'A');
+    assert(rename_formula("AB&").key != rename_formula("BA!&").key);
+
+    std::cout << "\033[0;32m✓ Renamed and reordered formulas share a key\033[0m" << std::endl;
+}
+
+void test_cached_results() {
+    std::cout << "\n\033[0;33mCached Results Tests----------------------\033[0m" << std::endl;
+
+    FormulaCache cache(64);
+    std::vector<std::string> formulas = {
+        "AB&!", "XY&!", "AB=", "QP=", "ABC&|", "BCA&|", "ZA!>", "AB^C|", "CBA^|",
+        "C!AB>&", "Z!XY>&", "AB>C!&", "AA!&", "AB&A|"
+    };
+
+    // the same strings as the uncached functions, on a miss and on a hit
+    for (int pass = 0; pass < 2; ++pass) {
+        for (const auto &f : formulas) {
+            std::string nnf = cache.negation_normal_form(f);
+            std::string cnf = cache.conjunctive_normal_form(f);
+            if (pass == 0) std::cout << f << " -> NNF " << nnf << ", CNF " << cnf << std::endl;
+            assert(nnf == negation_normal_form(f) && equivalent(f, nnf));
+            assert(cnf == conjunctive_normal_form(f) && equivalent(f, cnf));
+            assert(cache.sat(f) == sat(f));
+        }
+    }
+    assert(cache.sat("AA!&") == false);
+    assert(cache.sat("BB!&") == false);
+
+    CacheStats stats = cache.stats();
+    std::cout << "hits " << stats.hits << ", misses " << stats.misses
+              << ", hit rate " << stats.hit_rate() << std::endl;
+    assert(stats.hits > 0);
+    assert(stats.evictions == 0);
+
+    std::cout << "\033[0;32m✓ Cached results match the direct computation\033[0m" << std::endl;
+}
+
+void test_eviction() {
+    std::cout << "\n\033[0;33mEviction Tests----------------------\033[0m" << std::endl;
+
+    FormulaCache cache(4, 1);
+    std::vector<std::string> formulas = {"A", "AB&", "ABC&&", "ABCD&&&", "ABCDE&&&&", "AB|"};
+    for (const auto &f : formulas) cache.negation_normal_form(f);
+
+    CacheStats stats = cache.stats();
+    std::cout << "entries " << stats.entries << ", evictions " << stats.evictions << std::endl;
+    assert(stats.entries == 4);
+    assert(stats.evictions == 2);
+
+    // "A" was least recently used and is gone, "AB|" is still there
+    cache.negation_normal_form("XY|");
+    assert(cache.stats().hits == 1);
+    cache.negation_normal_form("A");
+    assert(cache.stats().misses == 7);
+
+    std::cout << "\033[0;32m✓ Least recently used entries are evicted\033[0m" << std::endl;
+}
+
+void test_concurrent_access() {
+    std::cout << "\n\033[0;33mConcurrent Access Tests----------------------\033[0m" << std::endl;
+
+    FormulaCache cache(256);
+    std::vector<std::thread> threads;
+    const char names[] = "ABCDEFGH";
+
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&cache, &names, t]() {
+            for (int i = 0; i < 200; ++i) {
+                std::string f = {names[(i + t) % 8], names[(i + t + 1) % 8], '&', names[(i + 3) % 8], '|', '!'};
+                std::string nnf = cache.negation_normal_form(f);
+                assert(equivalent(f, nnf));
+            }
+        });
+    }
+    for (auto &t : threads) t.join();
+
+    CacheStats stats = cache.stats();
+    std::cout << "hits " << stats.hits << ", misses " << stats.misses
+              << ", hit rate " << stats.hit_rate() << std::endl;
+    assert(stats.hits + stats.misses == 800);
+
+    std::cout << "\033[0;32m✓ Concurrent lookups are consistent\033[0m" << std::endl;
+}
+
+int main() {
+    try {
+        test_canonical_form();
+        test_cached_results();
+        test_eviction();
+        test_concurrent_access();
+
+        std::cout << "\n\033[0;32mAll tests passed! Formula cache is correct.\033[0m" << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << "Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
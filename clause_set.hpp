@@ -0,0 +1,380 @@
+#ifndef CLAUSE_SET_HPP
+#define CLAUSE_SET_HPP
+
+#include "boolean_algebra.hpp"
+
+// CNF as a flat clause set.
+//
+// Literals are packed as (variable << 1) | negated, variable 0 being 'A', and
+// all clauses share one literal array: clause i is
+// literals[offsets[i] .. offsets[i + 1]). Every clause is kept sorted with no
+// repeated literal, and tautologies (x | !x) are dropped as they are added.
+// simplify() then removes subsumed clauses and applies self-subsuming
+// resolution. RPN and DIMACS text are produced from the set on demand.
+
+using Literal = uint32_t;
+
+constexpr Literal make_literal(uint32_t variable, bool negated) {
+    return (variable << 1) | (negated ? 1u : 0u);
+}
+constexpr uint32_t literal_variable(Literal l) { return l >> 1; }
+constexpr bool literal_negated(Literal l) { return l & 1; }
+constexpr Literal negate_literal(Literal l) { return l ^ 1; }
+
+struct ClauseView {
+    const Literal *data;
+    size_t length;
+
+    const Literal *begin() const { return data; }
+    const Literal *end() const { return data + length; }
+    size_t size() const { return length; }
+    Literal operator[](size_t i) const { return data[i]; }
+};
+
+struct ClauseSetStats {
+    uint64_t duplicate_literals = 0;    // removed while adding clauses
+    uint64_t tautologies = 0;           // clauses dropped while adding
+    uint64_t subsumed = 0;              // clauses removed by simplify()
+    uint64_t strengthened = 0;          // literals removed by self-subsuming resolution
+};
+
+class ClauseSet {
+public:
+    ClauseSet() : offsets_{0} {}
+
+    size_t size() const { return offsets_.size() - 1; }
+    bool empty() const { return size() == 0; }
+    size_t literal_count() const { return literals_.size(); }
+    // one past the highest variable index in use
+    uint32_t variables() const { return variables_; }
+    bool has_empty_clause() const { return has_empty_clause_; }
+    const ClauseSetStats &stats() const { return stats_; }
+
+    const std::vector<Literal> &literals() const { return literals_; }
+    const std::vector<uint32_t> &offsets() const { return offsets_; }
+
+    ClauseView clause(size_t i) const {
+        return {literals_.data() + offsets_[i], offsets_[i + 1] - offsets_[i]};
+    }
+
+    // Sorts and deduplicates the clause; returns false for a tautology,
+    // which is not stored
+    bool add_clause(const Literal *first, size_t count) {
+        literals_.insert(literals_.end(), first, first + count);
+        return end_clause();
+    }
+
+    // Streaming construction without a per-clause buffer: the literals of
+    // one clause, then end_clause(), which normalizes them like add_clause
+    void push_literal(Literal l) { literals_.push_back(l); }
+    bool end_clause() { return commit_clause(offsets_.back()); }
+    bool clause_open() const { return literals_.size() != offsets_.back(); }
+
+    void reserve(size_t clauses, size_t literals) {
+        offsets_.reserve(clauses + 1);
+        literals_.reserve(literals);
+    }
+
+    // variables declared but possibly unused, as in a DIMACS header
+    void declare_variables(uint32_t count) { variables_ = std::max(variables_, count); }
+
+    bool add_clause(std::initializer_list<Literal> clause) {
+        return add_clause(clause.begin(), clause.size());
+    }
+
+    bool add_clause(const std::vector<Literal> &clause) {
+        return add_clause(clause.data(), clause.size());
+    }
+
+    void append(const ClauseSet &other) {
+        for (size_t i = 0; i < other.size(); ++i) {
+            ClauseView c = other.clause(i);
+            literals_.insert(literals_.end(), c.begin(), c.end());
+            offsets_.push_back(static_cast<uint32_t>(literals_.size()));
+        }
+        variables_ = std::max(variables_, other.variables_);
+        has_empty_clause_ = has_empty_clause_ || other.has_empty_clause_;
+        stats_.duplicate_literals += other.stats_.duplicate_literals;
+        stats_.tautologies += other.stats_.tautologies;
+    }
+
+    // Subsumption and self-subsuming resolution to a fixpoint.
+    //
+    // Clauses are visited shortest first and each deletes the clauses it
+    // subsumes (backward subsumption). Where D = D' | x and C = C' | !x with
+    // D' within C', resolving on x gives C', which subsumes C, so C just
+    // loses !x (self-subsuming resolution). A shortened clause is visited
+    // again and first checked against all shorter clauses, since it may now
+    // be subsumed or shortened by one visited earlier (forward subsumption).
+    void simplify() {
+        size_t n = size();
+        if (n < 2) return;
+
+        std::vector<uint32_t> begin(offsets_.begin(), offsets_.end() - 1);
+        std::vector<uint32_t> length(n);
+        std::vector<uint64_t> signature(n);
+        std::vector<bool> deleted(n, false);
+        std::vector<std::vector<uint32_t>> occurs(variables_);
+
+        for (uint32_t c = 0; c < n; ++c) {
+            length[c] = offsets_[c + 1] - offsets_[c];
+            signature[c] = clause_signature(&literals_[begin[c]], length[c]);
+            for (uint32_t k = 0; k < length[c]; ++k) occurs[literal_variable(literals_[begin[c] + k])].push_back(c);
+        }
+
+        std::vector<uint32_t> queue(n);
+        for (uint32_t c = 0; c < n; ++c) queue[c] = c;
+        std::sort(queue.begin(), queue.end(), [&](uint32_t a, uint32_t b) { return length[a] > length[b]; });
+        std::vector<bool> queued(n, true);
+        std::vector<bool> shortened(n, false);
+        std::vector<uint32_t> scratch;
+
+        auto remove_literal = [&](uint32_t c, Literal l) {
+            Literal *lits = &literals_[begin[c]];
+            Literal *end = std::remove(lits, lits + length[c], l);
+            length[c] = static_cast<uint32_t>(end - lits);
+            signature[c] = clause_signature(lits, length[c]);
+            auto &list = occurs[literal_variable(l)];
+            list.erase(std::find(list.begin(), list.end(), c));
+            ++stats_.strengthened;
+            if (length[c] == 0) has_empty_clause_ = true;
+            shortened[c] = true;
+            if (!queued[c]) {
+                queued[c] = true;
+                queue.push_back(c);
+            }
+        };
+
+        auto delete_clause = [&](uint32_t c) {
+            deleted[c] = true;
+            for (uint32_t k = 0; k < length[c]; ++k) {
+                auto &list = occurs[literal_variable(literals_[begin[c] + k])];
+                list.erase(std::find(list.begin(), list.end(), c));
+            }
+            ++stats_.subsumed;
+        };
+
+        while (!queue.empty()) {
+            uint32_t c = queue.back();
+            queue.pop_back();
+            queued[c] = false;
+            if (deleted[c] || length[c] == 0) continue;
+            limit_poll();
+
+            // forward: a shorter clause over some of c's variables drops or
+            // shortens c. On the first pass the backward checks of the
+            // clauses visited before c have done this already.
+            bool changed = false;
+            for (uint32_t k = 0; shortened[c] && k < length[c] && !changed; ++k) {
+                // nothing is removed from the list before the loop exits
+                const std::vector<uint32_t> &candidates = occurs[literal_variable(literals_[begin[c] + k])];
+                for (uint32_t d : candidates) {
+                    if (d == c || length[d] > length[c] || (signature[d] & ~signature[c]) != 0) continue;
+                    Literal flip;
+                    int r = self_subsumes(&literals_[begin[d]], length[d], &literals_[begin[c]], length[c], flip);
+                    if (r == SUBSUMES) { delete_clause(c); changed = true; break; }
+                    if (r == STRENGTHENS) { remove_literal(c, flip); changed = true; break; }
+                }
+            }
+            // a shortened c was queued again and is finished on that visit
+            if (changed) continue;
+
+            // backward: clauses c subsumes or shortens contain all of c's
+            // variables, so scanning the rarest one finds them all
+            uint32_t best = literal_variable(literals_[begin[c]]);
+            for (uint32_t k = 1; k < length[c]; ++k) {
+                uint32_t v = literal_variable(literals_[begin[c] + k]);
+                if (occurs[v].size() < occurs[best].size()) best = v;
+            }
+            // a copy: deleting d removes it from occurs[best]
+            scratch = occurs[best];
+            for (uint32_t d : scratch) {
+                if (d == c || length[d] < length[c] || (signature[c] & ~signature[d]) != 0) continue;
+                Literal flip;
+                int r = self_subsumes(&literals_[begin[c]], length[c], &literals_[begin[d]], length[d], flip);
+                if (r == SUBSUMES) delete_clause(d);
+                else if (r == STRENGTHENS) remove_literal(d, flip);
+            }
+        }
+
+        // compact the surviving clauses
+        std::vector<Literal> literals;
+        std::vector<uint32_t> offsets{0};
+        literals.reserve(literals_.size());
+        for (uint32_t c = 0; c < n; ++c) {
+            if (deleted[c]) continue;
+            literals.insert(literals.end(), literals_.begin() + begin[c], literals_.begin() + begin[c] + length[c]);
+            offsets.push_back(static_cast<uint32_t>(literals.size()));
+        }
+        literals_ = std::move(literals);
+        offsets_ = std::move(offsets);
+    }
+
+    // Clauses in order, literals joined with '|' and all '&' at the end. The
+    // empty set is "1" and a set holding the empty clause is "0", the
+    // constants conjunctive_normal_form returns for the same functions.
+    std::string to_rpn() const {
+        if (has_empty_clause_) return "0";
+        if (empty()) return "1";
+        if (variables_ > 26) throw std::invalid_argument("Error: clause set has more than 26 variables");
+
+        std::string out;
+        out.reserve(literals_.size() * 3);
+        for (size_t i = 0; i < size(); ++i) {
+            ClauseView c = clause(i);
+            for (size_t k = 0; k < c.size(); ++k) {
+                out += static_cast<char>('A' + literal_variable(c[k]));
+                if (literal_negated(c[k])) out += '!';
+                if (k > 0) out += '|';
+            }
+        }
+        out.append(size() - 1, '&');
+        return out;
+    }
+
+    // DIMACS CNF, variable v numbered v + 1
+    std::string to_dimacs() const {
+        std::ostringstream out;
+        out << "p cnf " << variables_ << ' ' << size() << '\n';
+        for (size_t i = 0; i < size(); ++i) {
+            for (Literal l : clause(i)) {
+                out << (literal_negated(l) ? "-" : "") << literal_variable(l) + 1 << ' ';
+            }
+            out << "0\n";
+        }
+        return out.str();
+    }
+
+private:
+    std::vector<Literal> literals_;
+    std::vector<uint32_t> offsets_;
+    uint32_t variables_ = 0;
+    bool has_empty_clause_ = false;
+    ClauseSetStats stats_;
+
+    enum { NO_RELATION, SUBSUMES, STRENGTHENS };
+
+    static uint64_t clause_signature(const Literal *lits, size_t n) {
+        uint64_t sig = 0;
+        for (size_t k = 0; k < n; ++k) sig |= uint64_t(1) << (literal_variable(lits[k]) & 63);
+        return sig;
+    }
+
+    // Both clauses sorted. SUBSUMES if c is a subset of d; STRENGTHENS if
+    // that holds with exactly one literal of c negated, `flip` being that
+    // literal as it appears in d
+    static int self_subsumes(const Literal *c, size_t cn, const Literal *d, size_t dn, Literal &flip) {
+        int result = SUBSUMES;
+        size_t j = 0;
+        for (size_t i = 0; i < cn; ++i) {
+            uint32_t v = literal_variable(c[i]);
+            while (j < dn && literal_variable(d[j]) < v) ++j;
+            if (j == dn || literal_variable(d[j]) != v) return NO_RELATION;
+            if (d[j] != c[i]) {
+                if (result == STRENGTHENS) return NO_RELATION;
+                result = STRENGTHENS;
+                flip = d[j];
+            }
+            ++j;
+        }
+        return result;
+    }
+
+    bool commit_clause(size_t start) {
+        auto first = literals_.begin() + start;
+        std::sort(first, literals_.end());
+        auto last = std::unique(first, literals_.end());
+        stats_.duplicate_literals += literals_.end() - last;
+        literals_.erase(last, literals_.end());
+
+        // sorted, so x and !x are neighbours
+        for (auto it = first; it + 1 < literals_.end(); ++it) {
+            if (*(it + 1) == negate_literal(*it)) {
+                literals_.erase(first, literals_.end());
+                ++stats_.tautologies;
+                return false;
+            }
+        }
+
+        if (first == literals_.end()) has_empty_clause_ = true;
+        else variables_ = std::max(variables_, literal_variable(literals_.back()) + 1);
+        offsets_.push_back(static_cast<uint32_t>(literals_.size()));
+        return true;
+    }
+};
+
+// Clauses of an NNF tree: a conjunction concatenates, a disjunction of
+// literals is one clause read off its operand list, and any other disjunction
+// takes the pairwise union of its operands' clauses and simplifies the
+// product, so subsumed clauses are pruned before they can multiply further up
+// the tree
+inline ClauseSet nnf_to_clause_set(const NNFNode *node) {
+    ClauseSet out;
+
+    if (node->type == NNFNode::CONST) {
+        // the whole formula folded: true has no clauses, false the empty one
+        if (node->variable == '0') out.add_clause(nullptr, 0);
+        return out;
+    }
+    if (node->type == NNFNode::VARIABLE) {
+        out.add_clause({make_literal(node->variable - 'A', false)});
+        return out;
+    }
+    if (node->type == NNFNode::NOT) {
+        out.add_clause({make_literal(node->operands[0]->variable - 'A', true)});
+        return out;
+    }
+
+    if (node->type == NNFNode::AND) {
+        for (const auto &operand : node->operands) out.append(nnf_to_clause_set(operand.get()));
+        return out;
+    }
+
+    std::vector<Literal> merged;
+    for (const auto &operand : node->operands) {
+        if (operand->type == NNFNode::VARIABLE) merged.push_back(make_literal(operand->variable - 'A', false));
+        else if (operand->type == NNFNode::NOT) merged.push_back(make_literal(operand->operands[0]->variable - 'A', true));
+        else break;
+    }
+    if (merged.size() == node->operands.size()) {
+        out.add_clause(merged);
+        return out;
+    }
+
+    // otherwise the operands' clauses are multiplied together one at a time
+    out = nnf_to_clause_set(node->operands[0].get());
+    for (size_t k = 1; k < node->operands.size(); ++k) {
+        ClauseSet left = std::move(out);
+        ClauseSet right = nnf_to_clause_set(node->operands[k].get());
+        out = ClauseSet();
+        for (size_t i = 0; i < left.size(); ++i) {
+            for (size_t j = 0; j < right.size(); ++j) {
+                limit_poll();
+                ClauseView a = left.clause(i), b = right.clause(j);
+                merged.assign(a.begin(), a.end());
+                merged.insert(merged.end(), b.begin(), b.end());
+                out.add_clause(merged);
+            }
+        }
+        out.simplify();
+    }
+    return out;
+}
+
+// conjunctive_normal_form as a simplified clause set
+inline ClauseSet conjunctive_normal_form_clauses(const std::string &rpn) {
+    auto ast = parse_rpn_to_ast(rpn);
+    ast = eliminate_complex_operators(std::move(ast));
+    ast = convert_to_nnf(std::move(ast));
+
+    ClauseSet clauses = nnf_to_clause_set(ast.get());
+    // a disjunction at the root was simplified by nnf_to_clause_set already
+    if (ast->type == NNFNode::AND) clauses.simplify();
+    return clauses;
+}
+
+inline Limited<ClauseSet> conjunctive_normal_form_clauses(const std::string &rpn, const ResourceLimits &limits) {
+    return run_with_limits<ClauseSet>(limits, [&] { return conjunctive_normal_form_clauses(rpn); });
+}
+
+#endif
@@ -0,0 +1,165 @@
+// clause set main
+
+#include <cassert>
+#include <random>
+#include "../clause_set.hpp"
+#include "../formula_generator.hpp"
+
+Literal pos(char v) { return make_literal(v - 'A', false); }
+Literal neg(char v) { return make_literal(v - 'A', true); }
+
+bool same_truth_table(const std::string &f, const std::string &g) {
+    uint32_t variables = formula_variables(f) | formula_variables(g);
+    return formula_truth_table_bits(f, variables) == formula_truth_table_bits(g, variables);
+}
+
+void test_literals() {
+    std::cout << "\033[0;33mLiteral Encoding Tests--------------------\033[0m" << std::endl;
+
+    static_assert(make_literal(2, true) == 5, "var << 1 | negated");
+    static_assert(literal_variable(5) == 2 && literal_negated(5), "decode");
+    static_assert(negate_literal(make_literal(3, false)) == make_literal(3, true), "negation flips bit 0");
+    std::cout << "\033[0;32m✓ (variable << 1) | negated\033[0m" << std::endl;
+}
+
+void test_add_clause() {
+    std::cout << "\n\033[0;33mClause Normalization Tests----------------\033[0m" << std::endl;
+
+    ClauseSet set;
+    assert(set.add_clause({pos('B'), pos('A'), pos('B')}));
+    assert(!set.add_clause({pos('C'), neg('A'), pos('A')}));
+    assert(set.size() == 1);
+    assert(set.clause(0).size() == 2 && set.clause(0)[0] == pos('A') && set.clause(0)[1] == pos('B'));
+    assert(set.stats().duplicate_literals == 1 && set.stats().tautologies == 1);
+    assert(set.offsets().size() == 2 && set.literal_count() == 2);
+    std::cout << set.to_rpn() << std::endl;
+    std::cout << "\033[0;32m✓ Duplicates removed, tautologies dropped\033[0m" << std::endl;
+}
+
+void test_simplify() {
+    std::cout << "\n\033[0;33mSubsumption Tests-------------------------\033[0m" << std::endl;
+
+    // A subsumes A | B whichever comes first
+    ClauseSet backward;
+    backward.add_clause({pos('A')});
+    backward.add_clause({pos('A'), pos('B')});
+    backward.simplify();
+    assert(backward.to_rpn() == "A");
+
+    ClauseSet forward;
+    forward.add_clause({pos('A'), pos('B'), pos('C')});
+    forward.add_clause({pos('C'), pos('A')});
+    forward.add_clause({pos('D')});
+    forward.simplify();
+    std::cout << "(A|B|C) & (A|C) & D -> " << forward.to_rpn() << std::endl;
+    assert(forward.to_rpn() == "AC|D&");
+    assert(forward.stats().subsumed == 1);
+    std::cout << "\033[0;32m✓ Forward and backward subsumption\033[0m" << std::endl;
+
+    // (A | B) & (A | !B) -> A
+    ClauseSet resolve;
+    resolve.add_clause({pos('A'), pos('B')});
+    resolve.add_clause({pos('A'), neg('B')});
+    resolve.simplify();
+    std::cout << "(A|B) & (A|!B) -> " << resolve.to_rpn() << std::endl;
+    assert(resolve.to_rpn() == "A");
+
+    // (A | B | C) & (!A | B) -> (B | C) & (!A | B)
+    ClauseSet strengthen;
+    strengthen.add_clause({pos('A'), pos('B'), pos('C')});
+    strengthen.add_clause({neg('A'), pos('B')});
+    strengthen.simplify();
+    std::cout << "(A|B|C) & (!A|B) -> " << strengthen.to_rpn() << std::endl;
+    assert(strengthen.to_rpn() == "BC|A!B|&");
+    assert(strengthen.stats().strengthened == 1);
+
+    // A & !A -> the empty clause
+    ClauseSet contradiction;
+    contradiction.add_clause({pos('A')});
+    contradiction.add_clause({neg('A')});
+    contradiction.simplify();
+    assert(contradiction.has_empty_clause() && contradiction.to_rpn() == "0");
+    std::cout << "\033[0;32m✓ Self-subsuming resolution\033[0m" << std::endl;
+}
+
+void test_serialization() {
+    std::cout << "\n\033[0;33mSerialization Tests-----------------------\033[0m" << std::endl;
+
+    ClauseSet set;
+    set.add_clause({pos('A'), neg('C')});
+    set.add_clause({pos('B')});
+    std::string dimacs = set.to_dimacs();
+    std::cout << dimacs;
+    assert(dimacs == "p cnf 3 2\n1 -3 0\n2 0\n");
+    assert(set.to_rpn() == "AC!|B&");
+
+    assert(ClauseSet().to_rpn() == "1");
+    assert(eval_formula(ClauseSet().to_rpn()) == true);
+    std::cout << "\033[0;32m✓ RPN and DIMACS views\033[0m" << std::endl;
+}
+
+void test_against_cnf() {
+    std::cout << "\n\033[0;33mAgainst conjunctive_normal_form Tests-----\033[0m" << std::endl;
+
+    std::vector<std::string> formulas = {"AB&!", "AB|!", "AB|C&", "AB|C|D|", "AB&C&D&", "AB&!C!|",
+                                         "AB=", "AB^C|", "AB>C=", "AB&CD&|", "AA!|B&"};
+    for (const auto &f : formulas) {
+        ClauseSet clauses = conjunctive_normal_form_clauses(f);
+        std::string cnf = conjunctive_normal_form(f);
+        std::cout << f << " -> " << clauses.to_rpn() << " (conjunctive_normal_form: " << cnf << ")" << std::endl;
+        assert(same_truth_table(f, clauses.to_rpn()));
+    }
+
+    // random formulas: equivalent, never more clauses than the tree CNF
+    int cases = 0;
+    for (FormulaShape shape : {FormulaShape::RANDOM, FormulaShape::XOR_HEAVY, FormulaShape::DEEP_CHAIN}) {
+        GeneratorOptions options;
+        options.shape = shape;
+        options.variables = 5;
+        options.depth = 3;
+        FormulaGenerator gen(11, options);
+        for (int i = 0; i < 100; ++i, ++cases) {
+            std::string f = gen.next();
+            ClauseSet clauses = conjunctive_normal_form_clauses(f);
+            std::string cnf = conjunctive_normal_form(f);
+            assert(same_truth_table(f, clauses.to_rpn()));
+            size_t tree_clauses = std::count(cnf.begin(), cnf.end(), '&') + 1;
+            assert(clauses.size() <= tree_clauses);
+        }
+    }
+    std::cout << cases << " random formulas equivalent, with at most as many clauses" << std::endl;
+    std::cout << "\033[0;32m✓ Same function as conjunctive_normal_form\033[0m" << std::endl;
+}
+
+void test_wide_conjunction() {
+    std::cout << "\n\033[0;33mWide Conjunction Tests--------------------\033[0m" << std::endl;
+
+    // 2000 clauses parse to one AND with 2000 operands, not a 2000-deep chain
+    std::mt19937 rng(7);
+    ClauseSet set;
+    while (set.size() < 2000) {
+        Literal c[6];
+        for (Literal &l : c) l = make_literal(rng() % 26, rng() & 1);
+        set.add_clause(c, 6);
+    }
+    std::string rpn = set.to_rpn();
+
+    auto ast = parse_rpn_to_ast(rpn);
+    assert(ast->type == NNFNode::AND && ast->operands.size() == set.size());
+    for (const auto &clause : ast->operands) assert(clause->type != NNFNode::AND);
+
+    std::string cnf = conjunctive_normal_form(rpn);
+    assert(size_t(std::count(cnf.begin(), cnf.end(), '&')) + 1 == set.size());
+    std::cout << set.size() << " clauses: one AND node, CNF unchanged" << std::endl;
+    std::cout << "\033[0;32m✓ Conjunctions are flattened on parse\033[0m" << std::endl;
+}
+
+int main() {
+    test_literals();
+    test_add_clause();
+    test_simplify();
+    test_serialization();
+    test_against_cnf();
+    test_wide_conjunction();
+    return 0;
+}
@@ -0,0 +1,142 @@
+// compile-time formulas main (C++20 for the fixed_string template parameters)
+
+#include <cassert>
+#include "../formula_template.hpp"
+
+// Rule invariants checked by the compiler: a broken rule fails the build
+static_assert(eval_rpn("10&").value == false);
+static_assert(eval_rpn("10|").value == true);
+static_assert(eval_rpn("1011||=").value == true);
+static_assert(eval_rpn("1&").status == EVAL_NOT_ENOUGH_OPERANDS);
+static_assert(eval_rpn("1x").status == EVAL_BAD_OPERAND);
+static_assert(eval_rpn("11").status == EVAL_BAD_CONSTRUCTION);
+static_assert(eval_rpn("AB&", 0b11).value == true);
+
+static_assert(formula_eval<"10>">() == false);
+static_assert(formula_eval<"AB>">(0b01) == false);
+static_assert(formula_nnf<"AB&!">() == "A!B!|");
+static_assert(formula_nnf<"AB=">() == "AB&A!B!&|");
+static_assert(formula_nnf<"AB^">() == "AB!&A!B&|");
+static_assert(formula_nnf<"A!!!">() == "A!");
+static_assert(formula_nnf<"A1&!">() == "A!0|");
+
+// De Morgan holds for every row
+static_assert(formula_truth_table<"AB&!">() == formula_truth_table<"A!B!|">());
+// contraposition
+static_assert(formula_truth_table<"AB>">() == formula_truth_table<"B!A!>">());
+
+// baked into the binary: rows 7, 5, 3, 1 and 6 of "AB&C|" are true
+constexpr auto baked_table = formula_truth_table<"AB&C|">();
+static_assert(baked_table.size() == 1 && baked_table[0] == 0b11101010);
+
+// 7 variables: 128 rows, two words
+constexpr auto wide_table = formula_truth_table<"ABCDEFG&&&&&&">();
+static_assert(wide_table.size() == 2 && wide_table[0] == 0 && wide_table[1] == (uint64_t(1) << 63));
+
+// expression templates: arguments are the variables in alphabetical order
+static_assert(Formula<"AB&C|">::arity == 3);
+static_assert(Formula<"AB&C|">::eval(true, true, false) == true);
+static_assert(Formula<"AB&C|">::eval(true, false, false) == false);
+static_assert(Formula<"CA>">::eval(false, true) == false);  // arguments are (A, C): 1 > 0
+static_assert(Formula<"1011||=">::eval() == true);
+static_assert(Formula<"AB^">::eval(uint64_t(0b1100), uint64_t(0b1010)) == 0b0110);
+
+template <fixed_string F>
+bool formula_matches_eval() {
+    using Compiled = Formula<F>;
+    uint32_t vars = formula_variables(F.view());
+    int n = count_variables(vars);
+
+    for (uint64_t row = 0; row < (uint64_t(1) << n); ++row) {
+        uint32_t assignment = row_assignment(vars, n, row);
+        std::string sub(F.view());
+        for (char &c : sub) {
+            if (c >= 'A' && c <= 'Z') c = ((assignment >> (c - 'A')) & 1) ? '1' : '0';
+        }
+        if (Compiled::eval_assignment(assignment) != eval_formula(sub)) return false;
+    }
+    return true;
+}
+
+void test_expression_templates() {
+    std::cout << "\n\033[0;33mExpression Template Tests----------------------\033[0m" << std::endl;
+
+    assert(formula_matches_eval<"AB&C|">());
+    assert(formula_matches_eval<"AB=C^D>!">());
+    assert(formula_matches_eval<"AB>C>D>">());
+    assert(formula_matches_eval<"ZA!&1|0^">());
+
+    // bit-sliced: every bit of the arguments is an independent row
+    uint64_t a = 0x0123456789abcdefULL, b = 0xfedcba9876543210ULL, c = 0x5555aaaa3333ccccULL;
+    uint64_t sliced = Formula<"AB&C|!">::eval(a, b, c);
+    for (int bit = 0; bit < 64; ++bit) {
+        bool scalar = Formula<"AB&C|!">::eval(bool((a >> bit) & 1), bool((b >> bit) & 1), bool((c >> bit) & 1));
+        assert(((sliced >> bit) & 1) == scalar);
+    }
+    std::cout << "AB&C|! over 64 rows -> " << std::hex << sliced << std::dec << std::endl;
+
+    std::cout << "\033[0;32m✓ Formula<F>::eval matches eval_formula\033[0m" << std::endl;
+}
+
+void test_runtime_agreement() {
+    std::cout << "\033[0;33mConstexpr vs Runtime Tests----------------------\033[0m" << std::endl;
+
+    // C++17 entry points with an explicit output capacity
+    std::vector<std::string> formulas = {
+        "AB&!", "AB|!", "AB>", "AB=", "AB^", "A!!", "A!!!", "AB&!!",
+        "ABC&|!", "ABC|&!", "AB>C=!", "AB^C>!", "ABCD&|&!", "AB=C^D>!",
+        "AB&C&D&", "AB|C|!D|", "AB&CD|>", "AB>C>D>", "AB|!C!D!&&!"
+    };
+    for (const auto &f : formulas) {
+        auto fixed = negation_normal_form_fixed<256>(f);
+        std::string runtime = negation_normal_form(f);
+        std::cout << f << " -> " << fixed.view() << std::endl;
+        assert(fixed == runtime);
+    }
+
+    // the runtime smart constructors fold these, the constexpr NNF does not:
+    // the strings differ but the functions agree on every row
+    for (const char *f : {"AA&", "AA!&", "AA^", "AB=A|", "A1&", "AB&A|!", "A0>B|", "1!"}) {
+        auto fixed = negation_normal_form_fixed<256>(f);
+        std::string runtime = negation_normal_form(f);
+        std::cout << f << " -> " << fixed.view() << " (runtime " << runtime << ")" << std::endl;
+        uint32_t vars = formula_variables(std::string_view(f));
+        int n = count_variables(vars);
+        for (uint64_t row = 0; row < (uint64_t(1) << n); ++row) {
+            uint32_t assignment = row_assignment(vars, n, row);
+            bool expected = eval_rpn(std::string_view(f), assignment).value;
+            assert(eval_rpn(fixed.view(), assignment).value == expected);
+            assert(eval_rpn(std::string_view(runtime), assignment).value == expected);
+        }
+    }
+
+    for (const char *f : {"AB&C|", "AB=", "ABC^>", "ABCDEFG&&&&&&"}) {
+        std::string_view view(f);
+        uint32_t vars = formula_variables(view);
+        int n = count_variables(vars);
+        for (uint64_t row = 0; row < (uint64_t(1) << n); ++row) {
+            std::string sub = f;
+            uint32_t assignment = row_assignment(vars, n, row);
+            for (char &c : sub) {
+                if (c >= 'A' && c <= 'Z') c = ((assignment >> (c - 'A')) & 1) ? '1' : '0';
+            }
+            assert(eval_rpn(view, assignment).value == eval_formula(sub));
+        }
+    }
+
+    std::cout << "\033[0;32m✓ Constexpr results agree with the runtime functions\033[0m" << std::endl;
+}
+
+int main() {
+    try {
+        test_runtime_agreement();
+        test_expression_templates();
+
+        std::cout << "\n\033[0;32mAll tests passed! Compile-time formulas are correct.\033[0m" << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << "Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,227 @@
+// common-subexpression elimination main
+
+#include <cassert>
+#include <random>
+#include "../formula_cse.hpp"
+#include "../formula_generator.hpp"
+
+// X <=> Y written out as ex05 does: (X & Y) | (!X & !Y)
+std::string expand_equivalence(const std::string &x, const std::string &y) {
+    return x + y + "&" + x + "!" + y + "!&|";
+}
+
+// 64 rows at once against eval_rpn_runtime on each row
+void check_formula(const CseFormula &cse, const std::string &formula, uint64_t seed) {
+    uint64_t columns[26];
+    for (int v = 0; v < 26; ++v) columns[v] = 0x9e3779b97f4a7c15ULL * (v + seed) ^ (0xdeadbeefULL << v);
+    uint64_t sliced = cse.eval_sliced(columns);
+    for (int bit = 0; bit < 64; ++bit) {
+        uint32_t assignment = 0;
+        for (int v = 0; v < 26; ++v) assignment |= static_cast<uint32_t>((columns[v] >> bit) & 1) << v;
+        bool expected = eval_rpn_runtime(formula, assignment, true).value;
+        assert(((sliced >> bit) & 1) == expected && cse.eval(assignment) == expected);
+    }
+}
+
+void test_sharing() {
+    std::cout << "\033[0;33mCSE Sharing Tests-------------------------\033[0m" << std::endl;
+
+    CseFormula twice("AB&BA&|");
+    std::cout << "AB&BA&|:\n" << twice.listing();
+    assert(twice.listing() == "%0 = A\n%1 = B\n%2 = %0 & %1\n%3 = %2 | %2\n");
+
+    // double negations fold, unused values are dropped
+    assert(CseFormula("A!!").program().size() == 1);
+    assert(CseFormula("A!!B!!>").listing() == "%0 = A\n%1 = B\n%2 = %0 > %1\n");
+    assert(CseFormula("BA>").listing() == "%0 = B\n%1 = A\n%2 = %0 > %1\n");
+    std::cout << "\033[0;32m✓ Repeated, reordered and doubly negated subexpressions share a value\033[0m" << std::endl;
+
+    // nested expanded equivalences double in length per level, the DAG grows
+    // by a constant
+    std::string f = "A";
+    for (int level = 1; level < 16; ++level) f = expand_equivalence(f, std::string(1, static_cast<char>('A' + level)));
+    CseFormula nested(f);
+    std::cout << "15 nested equivalences: " << nested.rpn_nodes() << " RPN nodes, " << nested.program().size()
+              << " values, " << nested.slots() << " slots" << std::endl;
+    assert(nested.rpn_nodes() == f.size() && nested.program().size() <= 1 + 7 * 15);
+    assert(nested.slots() <= 4);
+    for (uint64_t seed = 1; seed <= 4; ++seed) check_formula(nested, f, seed);
+
+    // ex05's own output
+    std::string nnf = negation_normal_form("AB=C=D=E=F=");
+    CseFormula from_nnf(nnf);
+    std::cout << "negation_normal_form(AB=C=D=E=F=): " << from_nnf.rpn_nodes() << " RPN nodes, "
+              << from_nnf.program().size() << " values" << std::endl;
+    assert(from_nnf.program().size() * 4 < from_nnf.rpn_nodes());
+    check_formula(from_nnf, nnf, 1);
+    std::cout << "\033[0;32m✓ Each unique subexpression computed once\033[0m" << std::endl;
+}
+
+void test_random() {
+    std::cout << "\n\033[0;33mCSE Random Formula Tests------------------\033[0m" << std::endl;
+
+    int cases = 0;
+    for (FormulaShape shape : {FormulaShape::RANDOM, FormulaShape::XOR_HEAVY, FormulaShape::CNF_LIKE, FormulaShape::DEEP_CHAIN}) {
+        GeneratorOptions options;
+        options.variables = 6;
+        options.depth = 7;
+        options.shape = shape;
+        FormulaGenerator gen(static_cast<int>(shape) + 11, options);
+        for (int i = 0; i < 100; ++i, ++cases) {
+            std::string f = gen.next();
+            CseFormula cse(f);
+            assert(cse.program().size() <= cse.rpn_nodes());
+            check_formula(cse, f, static_cast<uint64_t>(i));
+        }
+    }
+    for (const char *f : {"1", "0!", "10&", "1011||=", "A1&", "ZA!&1|0^"}) {
+        CseFormula cse(f);
+        check_formula(cse, f, 1);
+    }
+    std::cout << cases << " generated formulas" << std::endl;
+
+    // a long chain keeps two values live at a time
+    std::string chain = "A";
+    for (int v = 1; v < 26; ++v) chain += std::string(1, static_cast<char>('A' + v)) + "&|^>="[v % 5];
+    assert(CseFormula(chain).slots() == 2);
+    std::cout << "\033[0;32m✓ Scalar and bit-sliced results match eval_formula\033[0m" << std::endl;
+
+    // same errors as eval_formula
+    for (const char *f : {"1&", "11", "1x", ""}) {
+        std::string cse_error, eval_error;
+        try { CseFormula cse(f); } catch (const std::invalid_argument &e) { cse_error = e.what(); }
+        try { eval_formula(f); } catch (const std::invalid_argument &e) { eval_error = e.what(); }
+        assert(!cse_error.empty() && cse_error == eval_error);
+    }
+    std::cout << "\033[0;32m✓ Invalid formulas rejected\033[0m" << std::endl;
+}
+
+void test_batch() {
+    std::cout << "\n\033[0;33mBatch Evaluation Tests--------------------\033[0m" << std::endl;
+
+    // columnar records over A..F, a count that is not a multiple of 64 and
+    // spans several blocks
+    const size_t n = 64 * 70 + 13, words = (n + 63) / 64;
+    std::mt19937_64 rng(5);
+    std::vector<uint64_t> columns(6 * words);
+    for (uint64_t &w : columns) w = rng();
+    auto record = [&](size_t i) {
+        uint32_t assignment = 0;
+        for (size_t v = 0; v < 6; ++v) assignment |= static_cast<uint32_t>((columns[v * words + i / 64] >> (i % 64)) & 1) << v;
+        return assignment;
+    };
+
+    GeneratorOptions options;
+    options.variables = 6;
+    options.depth = 6;
+    FormulaGenerator gen(21, options);
+    BitVector out;
+    for (int i = 0; i < 40; ++i) {
+        std::string f = i == 0 ? "AB&C|" : gen.next();
+        eval_batch(f, columns.data(), n, out);
+        assert(out.size() == words && (out.back() >> (n % 64)) == 0);
+        for (size_t r = 0; r < n; ++r) {
+            assert(((out[r / 64] >> (r % 64)) & 1) == eval_rpn_runtime(f, record(r), true).value);
+        }
+    }
+    std::cout << "40 formulas over " << n << " records" << std::endl;
+
+    // constants need no columns, and no records give no words
+    eval_batch("10|", nullptr, 100, out);
+    assert(out.size() == 2 && out[0] == ~uint64_t(0) && out[1] == (uint64_t(1) << 36) - 1);
+    eval_batch("AB&", columns.data(), 0, out);
+    assert(out.empty());
+
+    // every pair of A..F live at once: registers beyond the stack buffer
+    std::string wide;
+    for (char a = 'A'; a <= 'F'; ++a) {
+        for (char b = static_cast<char>(a + 1); b <= 'F'; ++b) wide += std::string{a, b, '&'};
+    }
+    wide += std::string(14, '|');
+    CseFormula cse(wide);
+    assert(cse.slots() > 8);
+    BitVector compiled;
+    cse.eval_batch(columns.data(), n, compiled);
+    for (size_t r = 0; r < n; ++r) assert(((compiled[r / 64] >> (r % 64)) & 1) == cse.eval(record(r)));
+    std::cout << "\033[0;32m✓ eval_batch matches eval_formula on every record\033[0m" << std::endl;
+}
+
+void test_multiple_formulas() {
+    std::cout << "\n\033[0;33mShared Program Tests----------------------\033[0m" << std::endl;
+
+    // one formula's result is another's operand, two are the same formula
+    CseProgram small({"AB&", "BA&C|", "AB&", "1", "C!!"});
+    std::cout << "AB&, BA&C|, AB&, 1, C!!:\n" << small.listing();
+    assert(small.program().size() == 6);
+    assert((small.outputs() == std::vector<uint32_t>{2, 4, 2, 5, 3}));
+    for (uint32_t row = 0; row < 8; ++row) {
+        bool a = row & 1, b = row & 2, c = row & 4;
+        assert((small.eval(row) == std::vector<bool>{a && b, (a && b) || c, a && b, true, c}));
+    }
+    std::cout << "\033[0;32m✓ Results shared between formulas\033[0m" << std::endl;
+
+    // policies combining a few dozen common conditions: the program grows
+    // with the distinct subexpressions, not with the total length
+    GeneratorOptions options;
+    options.variables = 10;
+    options.depth = 3;
+    FormulaGenerator conditions_gen(8, options);
+    std::vector<std::string> conditions;
+    for (int i = 0; i < 24; ++i) conditions.push_back(conditions_gen.next());
+
+    std::mt19937 rng(3);
+    std::vector<std::string> policies;
+    size_t length = 0;
+    for (int i = 0; i < 2000; ++i) {
+        std::string p = conditions[rng() % conditions.size()];
+        for (int terms = 1 + rng() % 3; terms > 0; --terms) {
+            p += conditions[rng() % conditions.size()];
+            p += "&|>"[rng() % 3];
+        }
+        length += p.size();
+        policies.push_back(p);
+    }
+    CseProgram program(policies);
+    std::cout << policies.size() << " policies: " << program.rpn_nodes() << " RPN nodes, "
+              << program.program().size() << " values, " << program.slots() << " slots" << std::endl;
+    assert(program.formulas() == policies.size() && program.rpn_nodes() == length);
+    assert(program.program().size() * 4 < length);
+
+    // one pass over the records gives every policy's results
+    const size_t n = 64 * 40 + 7, words = (n + 63) / 64;
+    std::mt19937_64 bits(9);
+    std::vector<uint64_t> columns(10 * words);
+    for (uint64_t &w : columns) w = bits();
+    std::vector<BitVector> out;
+    program.eval_batch(columns.data(), n, out);
+    assert(out.size() == policies.size());
+    for (size_t k = 0; k < policies.size(); k += 7) {
+        BitVector expected;
+        eval_batch(policies[k], columns.data(), n, expected);
+        assert(out[k] == expected);
+    }
+
+    // the first 64 records as eval_sliced columns
+    uint64_t first[26] = {};
+    for (size_t v = 0; v < 10; ++v) first[v] = columns[v * words];
+    std::vector<uint64_t> sliced(policies.size());
+    program.eval_sliced(first, sliced.data());
+    for (size_t k = 0; k < policies.size(); ++k) assert(sliced[k] == out[k][0]);
+    std::cout << "\033[0;32m✓ Every policy evaluated in one pass\033[0m" << std::endl;
+
+    bool threw = false;
+    try {
+        CseProgram bad({"AB&", "A&"});
+    } catch (const std::invalid_argument &) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+int main() {
+    test_sharing();
+    test_random();
+    test_batch();
+    test_multiple_formulas();
+    return 0;
+}
@@ -0,0 +1,306 @@
+#ifndef DIMACS_HPP
+#define DIMACS_HPP
+
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "clause_set.hpp"
+
+// DIMACS CNF import and export.
+//
+// The reader takes "p cnf <variables> <clauses>" followed by clauses of
+// signed variable numbers, each terminated by 0, skipping 'c' comment lines
+// and stopping at a '%' line (the SATLIB end marker). Literals are pushed
+// straight into the ClauseSet's flat array, so loading allocates only when
+// that array grows; read_dimacs maps the file rather than reading it.
+// DIMACS variable v + 1 is library variable v ('A' + v).
+
+class DimacsParser {
+public:
+    DimacsParser(const char *begin, const char *end) : p_(begin), end_(end) {}
+
+    ClauseSet parse() {
+        uint64_t declared_clauses = read_header();
+
+        ClauseSet set;
+        set.declare_variables(variables_);
+        // typical instances use under four bytes per literal
+        set.reserve(declared_clauses, static_cast<size_t>(end_ - p_) / 4);
+
+        uint64_t clauses = 0;
+        for (;;) {
+            skip_space();
+            if (p_ == end_ || *p_ == '%') break;
+            if (*p_ == 'c') { skip_line(); continue; }
+
+            int64_t value = read_int();
+            if (value == 0) {
+                set.end_clause();
+                ++clauses;
+                continue;
+            }
+            uint64_t variable = static_cast<uint64_t>(value < 0 ? -value : value);
+            if (variable > variables_) error("variable " + std::to_string(variable) + " exceeds the header's " + std::to_string(variables_));
+            set.push_literal(make_literal(static_cast<uint32_t>(variable - 1), value < 0));
+        }
+
+        // the last clause may omit its terminating 0
+        if (set.clause_open()) {
+            set.end_clause();
+            ++clauses;
+        }
+        if (clauses != declared_clauses) {
+            error("header declares " + std::to_string(declared_clauses) + " clauses, found " + std::to_string(clauses));
+        }
+        return set;
+    }
+
+private:
+    const char *p_;
+    const char *end_;
+    size_t line_ = 1;
+    uint32_t variables_ = 0;
+
+    [[noreturn]] void error(const std::string &message) const {
+        throw std::invalid_argument("Error: DIMACS line " + std::to_string(line_) + ": " + message);
+    }
+
+    void skip_space() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\r' || *p_ == '\n')) {
+            if (*p_ == '\n') ++line_;
+            ++p_;
+        }
+    }
+
+    void skip_line() {
+        const void *newline = std::memchr(p_, '\n', static_cast<size_t>(end_ - p_));
+        p_ = newline ? static_cast<const char *>(newline) : end_;
+    }
+
+    int64_t read_int() {
+        bool negative = p_ < end_ && *p_ == '-';
+        if (negative) ++p_;
+        if (p_ == end_ || *p_ < '0' || *p_ > '9') error("expected a number");
+
+        int64_t value = 0;
+        while (p_ < end_ && *p_ >= '0' && *p_ <= '9') {
+            value = value * 10 + (*p_++ - '0');
+            if (value > INT32_MAX) error("number out of range");
+        }
+        if (p_ < end_ && *p_ != ' ' && *p_ != '\t' && *p_ != '\r' && *p_ != '\n') error("expected a number");
+        return negative ? -value : value;
+    }
+
+    void expect_word(const char *word) {
+        skip_space();
+        size_t n = std::strlen(word);
+        if (static_cast<size_t>(end_ - p_) < n || std::memcmp(p_, word, n) != 0) {
+            error(std::string("expected '") + word + "'");
+        }
+        p_ += n;
+    }
+
+    uint64_t read_header() {
+        for (;;) {
+            skip_space();
+            if (p_ == end_) error("missing 'p cnf' header");
+            if (*p_ != 'c') break;
+            skip_line();
+        }
+        expect_word("p");
+        expect_word("cnf");
+        skip_space();
+        int64_t variables = read_int();
+        skip_space();
+        int64_t clauses = read_int();
+        if (variables < 0 || clauses < 0) error("negative count in header");
+        variables_ = static_cast<uint32_t>(variables);
+        return static_cast<uint64_t>(clauses);
+    }
+};
+
+inline ClauseSet parse_dimacs(std::string_view text) {
+    return DimacsParser(text.data(), text.data() + text.size()).parse();
+}
+
+inline ClauseSet read_dimacs(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Error: cannot open " + path + ": " + std::strerror(errno));
+
+    struct stat st;
+    if (::fstat(fd, &st) < 0) {
+        int saved = errno;
+        ::close(fd);
+        throw std::runtime_error("Error: cannot stat " + path + ": " + std::strerror(saved));
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    if (size == 0) {
+        ::close(fd);
+        return parse_dimacs("");
+    }
+
+    void *mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) throw std::runtime_error("Error: cannot map " + path + ": " + std::strerror(errno));
+    ::madvise(mapped, size, MADV_SEQUENTIAL);
+
+    const char *data = static_cast<const char *>(mapped);
+    try {
+        ClauseSet set = DimacsParser(data, data + size).parse();
+        ::munmap(mapped, size);
+        return set;
+    } catch (...) {
+        ::munmap(mapped, size);
+        throw;
+    }
+}
+
+// Buffered writes to a file descriptor. Call flush() to see write errors;
+// the destructor flushes too but cannot report them.
+class DimacsWriter {
+public:
+    explicit DimacsWriter(int fd) : fd_(fd) { buffer_.reserve(kBufferSize + 32); }
+    ~DimacsWriter() {
+        try {
+            flush();
+        } catch (const std::exception &) {
+        }
+    }
+
+    DimacsWriter(const DimacsWriter &) = delete;
+    DimacsWriter &operator=(const DimacsWriter &) = delete;
+
+    void write(const ClauseSet &set) {
+        text("p cnf ");
+        number(set.variables());
+        buffer_ += ' ';
+        number(static_cast<int64_t>(set.size()));
+        buffer_ += '\n';
+
+        for (size_t i = 0; i < set.size(); ++i) {
+            for (Literal l : set.clause(i)) {
+                int64_t v = static_cast<int64_t>(literal_variable(l)) + 1;
+                number(literal_negated(l) ? -v : v);
+                buffer_ += ' ';
+            }
+            text("0\n");
+            if (buffer_.size() >= kBufferSize) flush();
+        }
+    }
+
+    void flush() {
+        const char *data = buffer_.data();
+        size_t size = buffer_.size();
+        while (size > 0) {
+            ssize_t written = ::write(fd_, data, size);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                buffer_.clear();
+                throw std::runtime_error(std::string("Error: write failed: ") + std::strerror(errno));
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+        buffer_.clear();
+    }
+
+private:
+    static constexpr size_t kBufferSize = 1 << 16;
+    int fd_;
+    std::string buffer_;
+
+    void text(const char *s) { buffer_ += s; }
+
+    void number(int64_t value) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        buffer_.append(digits, result.ptr);
+    }
+};
+
+inline void write_dimacs(int fd, const ClauseSet &set) {
+    DimacsWriter writer(fd);
+    writer.write(set);
+    writer.flush();
+}
+
+inline void write_dimacs_file(const std::string &path, const ClauseSet &set) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) throw std::runtime_error("Error: cannot open " + path + ": " + std::strerror(errno));
+    try {
+        write_dimacs(fd, set);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd);
+}
+
+// Clauses of a CNF string as conjunctive_normal_form returns it, read without
+// building a tree. In RPN the two operands of an operator are the last two
+// entries on the stack, and their literals are the last ones emitted, so '|'
+// just joins the two trailing clauses and '&' leaves the clause list as is.
+// The constants conjunctive_normal_form returns for a contradiction or a
+// tautology come back as the empty clause and as no clauses.
+inline ClauseSet clause_set_from_cnf_rpn(std::string_view cnf) {
+    if (cnf == "0" || cnf == "1") {
+        ClauseSet set;
+        if (cnf == "0") set.add_clause(nullptr, 0);
+        return set;
+    }
+
+    std::vector<Literal> literals;
+    std::vector<uint32_t> starts;         // first literal of each clause
+    std::vector<bool> conjunction;        // stack: does the entry hold several clauses
+    literals.reserve(cnf.size());
+
+    for (size_t i = 0; i < cnf.size(); ++i) {
+        char c = cnf[i];
+        if (c >= 'A' && c <= 'Z') {
+            starts.push_back(static_cast<uint32_t>(literals.size()));
+            literals.push_back(make_literal(static_cast<uint32_t>(c - 'A'), false));
+            conjunction.push_back(false);
+        } else if (c == '!') {
+            if (i == 0 || cnf[i - 1] < 'A' || cnf[i - 1] > 'Z') {
+                throw std::invalid_argument("Error: formula is not in CNF: negation of a non-variable");
+            }
+            literals.back() = negate_literal(literals.back());
+        } else if (c == '|' || c == '&') {
+            if (conjunction.size() < 2) {
+                throw std::invalid_argument("Error: Invalid RPN expression: not enough operands");
+            }
+            bool right = conjunction.back(); conjunction.pop_back();
+            bool left = conjunction.back();
+            if (c == '|') {
+                if (left || right) throw std::invalid_argument("Error: formula is not in CNF: conjunction under a disjunction");
+                starts.pop_back();      // the right clause continues the left one
+            } else {
+                conjunction.back() = true;
+            }
+        } else {
+            throw std::invalid_argument("Error: formula is not in CNF: unexpected character");
+        }
+    }
+    if (conjunction.size() != 1) {
+        throw std::invalid_argument("Error: Invalid RPN expression: bad construction");
+    }
+
+    ClauseSet set;
+    set.reserve(starts.size(), literals.size());
+    starts.push_back(static_cast<uint32_t>(literals.size()));
+    for (size_t k = 0; k + 1 < starts.size(); ++k) {
+        set.add_clause(literals.data() + starts[k], starts[k + 1] - starts[k]);
+    }
+    return set;
+}
+
+// conjunctive_normal_form output straight to DIMACS
+inline void write_cnf_dimacs(int fd, const std::string &cnf_rpn) {
+    write_dimacs(fd, clause_set_from_cnf_rpn(cnf_rpn));
+}
+
+#endif
@@ -0,0 +1,146 @@
+// DIMACS main
+
+#include <cassert>
+#include <chrono>
+#include <random>
+#include "../dimacs.hpp"
+
+bool throws(const std::string &text) {
+    try {
+        parse_dimacs(text);
+    } catch (const std::invalid_argument &e) {
+        std::cout << "  " << e.what() << std::endl;
+        return true;
+    }
+    return false;
+}
+
+void test_parse() {
+    std::cout << "\033[0;33mDIMACS Parsing Tests----------------------\033[0m" << std::endl;
+
+    ClauseSet set = parse_dimacs(
+        "c an example\n"
+        "c\n"
+        "p cnf 4 3\n"
+        " 1 -3 0\n"
+        "2 3 -1 0\n"
+        "c mid-file comment\n"
+        "-4\n0\n");
+    assert(set.size() == 3 && set.variables() == 4);
+    assert(set.to_rpn() == "AC!|A!B|C|D!&&");
+    std::cout << "p cnf 4 3 -> " << set.to_rpn() << std::endl;
+
+    // SATLIB end marker, missing final 0, tabs and CRLF
+    ClauseSet satlib = parse_dimacs("p cnf 2 2\r\n1\t2 0\r\n-1 -2\n%\n0\n");
+    assert(satlib.size() == 2);
+    assert(parse_dimacs("p cnf 3 1\n1 -2").to_rpn() == "AB!|");
+
+    // declared but unused variables are kept
+    assert(parse_dimacs("p cnf 10 1\n1 0\n").variables() == 10);
+    std::cout << "\033[0;32m✓ Comments, end markers and whitespace\033[0m" << std::endl;
+
+    std::cout << "Rejected inputs:" << std::endl;
+    assert(throws("1 2 0\n"));
+    assert(throws("p dnf 2 1\n1 2 0\n"));
+    assert(throws("p cnf 2 1\n1 3 0\n"));
+    assert(throws("p cnf 2 2\n1 2 0\n"));
+    assert(throws("p cnf 2 1\n1 x 0\n"));
+    assert(throws("p cnf 2 1\n1 99999999999 0\n"));
+    std::cout << "\033[0;32m✓ Malformed files report the line\033[0m" << std::endl;
+}
+
+void test_cnf_rpn() {
+    std::cout << "\n\033[0;33mCNF String Tests--------------------------\033[0m" << std::endl;
+
+    for (std::string f : {"AB&!", "AB|C&", "AB=", "AB^C|", "AB&CD&|", "AB>C="}) {
+        std::string cnf = conjunctive_normal_form(f);
+        ClauseSet set = clause_set_from_cnf_rpn(cnf);
+        std::cout << f << " -> " << cnf << " -> " << set.size() << " clauses" << std::endl;
+        assert(set.size() == static_cast<size_t>(std::count(cnf.begin(), cnf.end(), '&') + 1)
+               || set.stats().tautologies > 0);
+    }
+    assert(clause_set_from_cnf_rpn("AB|C!D|&").to_rpn() == "AB|C!D|&");
+
+    // contradictions and tautologies come back from CNF as constants
+    for (std::string f : {"AA!&", "AA!|", "AB&A!&"}) {
+        std::string cnf = conjunctive_normal_form(f);
+        ClauseSet set = clause_set_from_cnf_rpn(cnf);
+        std::cout << f << " -> " << cnf << " -> " << set.size() << " clauses" << std::endl;
+        assert(set.to_rpn() == cnf);
+    }
+    assert(clause_set_from_cnf_rpn("0").has_empty_clause() && clause_set_from_cnf_rpn("1").empty());
+
+    bool threw = false;
+    try {
+        clause_set_from_cnf_rpn("AB&C|");
+    } catch (const std::invalid_argument &) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "\033[0;32m✓ CNF strings read without a tree\033[0m" << std::endl;
+}
+
+void test_round_trip() {
+    std::cout << "\n\033[0;33mRound Trip Tests--------------------------\033[0m" << std::endl;
+
+    const std::string path = "/tmp/ready_set_boole_dimacs_test.cnf";
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    assert(fd >= 0);
+    write_cnf_dimacs(fd, conjunctive_normal_form("AB=C|"));
+    ::close(fd);
+
+    ClauseSet back = read_dimacs(path);
+    std::cout << "AB=C| -> DIMACS -> " << back.to_rpn() << std::endl;
+    assert(back.to_dimacs() == clause_set_from_cnf_rpn(conjunctive_normal_form("AB=C|")).to_dimacs());
+
+    for (std::string f : {"AA!&", "AA!|"}) {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        assert(fd >= 0);
+        write_cnf_dimacs(fd, conjunctive_normal_form(f));
+        ::close(fd);
+        back = read_dimacs(path);
+        std::cout << f << " -> DIMACS -> " << back.to_rpn() << std::endl;
+        assert(back.to_rpn() == conjunctive_normal_form(f));
+    }
+
+    // a random 3-SAT instance through the file
+    std::mt19937 rng(3);
+    ClauseSet big;
+    const uint32_t variables = 5000;
+    const size_t clauses = 200000;
+    for (size_t i = 0; i < clauses; ++i) {
+        Literal c[3];
+        for (Literal &l : c) l = make_literal(rng() % variables, rng() & 1);
+        big.add_clause(c, 3);
+    }
+    big.declare_variables(variables);
+    write_dimacs_file(path, big);
+
+    auto start = std::chrono::steady_clock::now();
+    ClauseSet loaded = read_dimacs(path);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    struct stat st;
+    ::stat(path.c_str(), &st);
+    std::cout << "read " << loaded.size() << " clauses (" << st.st_size / (1 << 20) << " MiB) in "
+              << seconds * 1000 << " ms" << std::endl;
+    assert(loaded.size() == big.size());
+    assert(loaded.literals() == big.literals() && loaded.offsets() == big.offsets());
+    ::unlink(path.c_str());
+
+    bool threw = false;
+    try {
+        read_dimacs("/nonexistent/file.cnf");
+    } catch (const std::runtime_error &) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "\033[0;32m✓ Write and read back unchanged\033[0m" << std::endl;
+}
+
+int main() {
+    test_parse();
+    test_cnf_rpn();
+    test_round_trip();
+    return 0;
+}
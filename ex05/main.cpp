@@ -58,7 +58,7 @@ void test_complex_nested() {
     std::cout << "ABC|&! -> " << negation_normal_form("ABC|&!") << std::endl; // Expected: A!BC|!|
     
     // Multiple operators
-    std::cout << "AB&CD|> -> " << negation_normal_form("AB&CD|>") << std::endl; // Expected: AB&!CD||
+    std::cout << "AB&CD|> -> " << negation_normal_form("AB&CD|>") << std::endl; // Expected: A!B!CD|||
     std::cout << "AB>CD>& -> " << negation_normal_form("AB>CD>&") << std::endl; // Expected: A!B|C!D|&
     
     // Equivalence with other operators
@@ -110,6 +110,27 @@ void test_edge_cases() {
     std::cout << std::endl;
 }
 
+void test_simplification() {
+    std::cout << "\033[0;33mSIMPLIFICATION----------------------\033[0m" << std::endl;
+    
+    // Idempotence and complement
+    std::cout << "AA& -> " << negation_normal_form("AA&") << std::endl;      // Expected: A
+    std::cout << "AA!| -> " << negation_normal_form("AA!|") << std::endl;    // Expected: 1
+    std::cout << "AA^ -> " << negation_normal_form("AA^") << std::endl;      // Expected: 0
+    std::cout << "AA= -> " << negation_normal_form("AA=") << std::endl;      // Expected: 1
+    
+    // Absorption
+    std::cout << "AAB|& -> " << negation_normal_form("AAB|&") << std::endl;  // Expected: A
+    std::cout << "AB&A| -> " << negation_normal_form("AB&A|") << std::endl;  // Expected: A
+    
+    // Constants, as eval_formula accepts them
+    std::cout << "A1& -> " << negation_normal_form("A1&") << std::endl;      // Expected: A
+    std::cout << "A0> -> " << negation_normal_form("A0>") << std::endl;      // Expected: A!
+    std::cout << "AB1^& -> " << negation_normal_form("AB1^&") << std::endl;  // Expected: AB!&
+    
+    std::cout << std::endl;
+}
+
 void verify_nnf_property(const std::string& original, const std::string& nnf) { 
     for (size_t i = 0; i < nnf.length(); i++) {
         if (nnf[i] == '!') {
@@ -167,6 +188,7 @@ int main() {
         test_complex_nested();
         test_multiple_variables();
         test_edge_cases();
+        test_simplification();
         test_nnf_validity();
         
         std::cout << "\033[0;32m✓ ALL TESTS COMPLETED!\033[0m" << std::endl;
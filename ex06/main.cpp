@@ -119,6 +119,21 @@ void test_double_negation() {
     std::cout << std::endl;
 }
 
+void test_simplification() {
+    std::cout << "\033[0;33mSIMPLIFICATION----------------------\033[0m" << std::endl;
+    
+    // Folded before distribution: (A & A) | (B ^ B) is just A
+    std::cout << "AA&BB^| -> " << conjunctive_normal_form("AA&BB^|") << std::endl;   // Expected: A
+    
+    // (A | B) & A absorbs to A instead of two clauses
+    std::cout << "AB|A&C| -> " << conjunctive_normal_form("AB|A&C|") << std::endl;   // Expected: AC|
+    
+    // A tautology leaves no clauses to distribute
+    std::cout << "AA!|BC&D&| -> " << conjunctive_normal_form("AA!|BC&D&|") << std::endl; // Expected: 1
+    
+    std::cout << std::endl;
+}
+
 bool verify_cnf_structure(const std::string& formula) {
     // A valid CNF should have the pattern: literals connected by |, then & at the end
     // This is a simplified check - in RPN, we should see variables/negations, then |'s, then &'s
@@ -243,6 +258,7 @@ int main() {
         test_multiple_variables();
         test_nested_distribution();
         test_double_negation();
+        test_simplification();
         test_cnf_validity();
         test_truth_table_equivalence();
         
@@ -0,0 +1,278 @@
+#ifndef FORMULA_CACHE_HPP
+#define FORMULA_CACHE_HPP
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include "boolean_algebra.hpp"
+
+// Result cache for negation_normal_form, conjunctive_normal_form and sat.
+//
+// Formulas are keyed with their variables renamed A, B, C... in order of
+// first appearance, so "AB&" and "XY&" share one entry. Results are stored in
+// that naming and renamed back to the caller's variables on every lookup.
+// The normal forms compare variables only for equality, so a renamed result
+// is exactly what the uncached function returns; they keep operand order,
+// so only sat, whose answer does not depend on it, also orders the operands
+// of the commutative operators (& | ^ =) and shares "AB&" with "BA&".
+
+struct CanonicalFormula {
+    std::string key;              // canonical RPN, variables renamed A, B, C...
+    char to_original[26] = {};    // to_original[canonical - 'A'] = caller's variable
+    char to_canonical[26] = {};   // to_canonical[caller's - 'A'] = canonical variable
+};
+
+struct CanonNode {
+    char op;
+    int left = -1;
+    int right = -1;
+    uint64_t hash = 0;
+};
+
+inline uint64_t canon_mix(uint64_t h, uint64_t v) {
+    // splitmix64 finaliser over the running hash
+    h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    h ^= h >> 30; h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27; h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+inline bool canon_commutative(char op) {
+    return op == '&' || op == '|' || op == '^' || op == '=';
+}
+
+// Builds the canonical RPN: children of commutative operators are emitted in
+// structural-hash order (variables all hash alike, so the order does not
+// depend on their names), and variables are renamed in the order they are
+// first emitted.
+inline void canon_emit(const std::vector<CanonNode> &nodes, int index, CanonicalFormula &out, int &next_var) {
+    const CanonNode &node = nodes[index];
+
+    if (node.op >= 'A' && node.op <= 'Z') {
+        char &mapped = out.to_canonical[node.op - 'A'];
+        if (!mapped) {
+            mapped = static_cast<char>('A' + next_var);
+            out.to_original[next_var++] = node.op;
+        }
+        out.key += mapped;
+        return;
+    }
+    if (node.op == '0' || node.op == '1') {
+        out.key += node.op;
+        return;
+    }
+    if (node.op == '!') {
+        canon_emit(nodes, node.right, out, next_var);
+        out.key += '!';
+        return;
+    }
+
+    int first = node.left;
+    int second = node.right;
+    if (canon_commutative(node.op) && nodes[second].hash < nodes[first].hash) {
+        std::swap(first, second);
+    }
+    canon_emit(nodes, first, out, next_var);
+    canon_emit(nodes, second, out, next_var);
+    out.key += node.op;
+}
+
+inline CanonicalFormula canonicalize_formula(const std::string &rpn) {
+    std::vector<CanonNode> nodes;
+    std::vector<int> stack;
+    nodes.reserve(rpn.size());
+
+    for (char c : rpn) {
+        CanonNode node;
+        node.op = c;
+
+        if ((c >= 'A' && c <= 'Z') || c == '0' || c == '1') {
+            // all variables share one hash: the shape must not depend on names
+            node.hash = canon_mix(0, (c >= 'A' && c <= 'Z') ? 'V' : c);
+        } else if (c == '!') {
+            if (stack.empty()) {
+                throw std::invalid_argument("Error: Invalid RPN expression: not enough operands");
+            }
+            node.right = stack.back(); stack.pop_back();
+            node.hash = canon_mix(canon_mix(0, c), nodes[node.right].hash);
+        } else if (check_operand(c)) {
+            if (stack.size() < 2) {
+                throw std::invalid_argument("Error: Invalid RPN expression: not enough operands");
+            }
+            node.right = stack.back(); stack.pop_back();
+            node.left = stack.back(); stack.pop_back();
+
+            uint64_t hl = nodes[node.left].hash;
+            uint64_t hr = nodes[node.right].hash;
+            if (canon_commutative(c) && hr < hl) std::swap(hl, hr);
+            node.hash = canon_mix(canon_mix(canon_mix(0, c), hl), hr);
+        } else {
+            throw std::invalid_argument("Error: Invalid RPN expression: bad operand");
+        }
+
+        stack.push_back(static_cast<int>(nodes.size()));
+        nodes.push_back(node);
+    }
+
+    if (stack.size() != 1) {
+        throw std::invalid_argument("Error: Invalid RPN expression: bad construction");
+    }
+
+    CanonicalFormula result;
+    result.key.reserve(rpn.size() + 1);
+    int next_var = 0;
+    canon_emit(nodes, stack.back(), result, next_var);
+    return result;
+}
+
+// The formula as written with only its variables renamed, in order of first
+// appearance; not validated, a malformed formula fails in the computation
+inline CanonicalFormula rename_formula(const std::string &rpn) {
+    CanonicalFormula result;
+    result.key.reserve(rpn.size() + 1);
+    int next_var = 0;
+    for (char c : rpn) {
+        if (c >= 'A' && c <= 'Z') {
+            char &mapped = result.to_canonical[c - 'A'];
+            if (!mapped) {
+                mapped = static_cast<char>('A' + next_var);
+                result.to_original[next_var++] = c;
+            }
+            c = mapped;
+        }
+        result.key += c;
+    }
+    return result;
+}
+
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+
+    double hit_rate() const {
+        uint64_t total = hits + misses;
+        return total ? static_cast<double>(hits) / static_cast<double>(total) : 0.0;
+    }
+};
+
+class FormulaCache {
+public:
+    // capacity is the total number of cached results, split evenly over shards
+    explicit FormulaCache(size_t capacity = 4096, size_t shards = 16)
+        : shards_(std::max<size_t>(1, std::min(shards, capacity ? capacity : 1))) {
+        size_t per_shard = std::max<size_t>(1, capacity / shards_.size());
+        for (auto &shard : shards_) shard.capacity = per_shard;
+    }
+
+    std::string negation_normal_form(const std::string &rpn) {
+        return lookup('N', rename_formula(rpn), rpn, [](const std::string &f) { return ::negation_normal_form(f); });
+    }
+
+    std::string conjunctive_normal_form(const std::string &rpn) {
+        return lookup('C', rename_formula(rpn), rpn, [](const std::string &f) { return ::conjunctive_normal_form(f); });
+    }
+
+    bool sat(const std::string &formula) {
+        try {
+            return lookup('S', canonicalize_formula(formula), formula, [](const std::string &f) {
+                return std::string(::sat(f) ? "1" : "0");
+            }) == "1";
+        } catch (const std::invalid_argument &) {
+            // malformed input: keep ::sat's report-and-return-false behaviour
+            return ::sat(formula);
+        }
+    }
+
+    CacheStats stats() const {
+        CacheStats total;
+        for (const auto &shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total.hits += shard.hits;
+            total.misses += shard.misses;
+            total.evictions += shard.evictions;
+            total.entries += shard.lru.size();
+        }
+        return total;
+    }
+
+    void clear() {
+        for (auto &shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.lru.clear();
+            shard.index.clear();
+            shard.hits = shard.misses = shard.evictions = 0;
+        }
+    }
+
+private:
+    struct Entry {
+        std::string key;
+        std::string result;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> lru;    // most recently used first
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+        size_t capacity = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+
+    std::vector<Shard> shards_;
+
+    static std::string rename(const std::string &result, const char *mapping) {
+        std::string out = result;
+        for (char &c : out) {
+            if (c >= 'A' && c <= 'Z') c = mapping[c - 'A'];
+        }
+        return out;
+    }
+
+    // A miss computes on the caller's formula and stores the result in the
+    // key's naming
+    template <typename Compute>
+    std::string lookup(char pass, CanonicalFormula canon, const std::string &rpn, Compute compute) {
+        canon.key += pass;
+
+        Shard &shard = shards_[std::hash<std::string>()(canon.key) % shards_.size()];
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.index.find(canon.key);
+            if (it != shard.index.end()) {
+                shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+                ++shard.hits;
+                return rename(it->second->result, canon.to_original);
+            }
+            ++shard.misses;
+        }
+
+        // computed outside the lock: concurrent misses on one key may both
+        // compute, the second insert just refreshes the entry
+        std::string result = compute(rpn);
+        std::string stored = rename(result, canon.to_canonical);
+
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.index.find(canon.key);
+            if (it != shard.index.end()) {
+                shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            } else {
+                shard.lru.push_front(Entry{canon.key, std::move(stored)});
+                shard.index.emplace(canon.key, shard.lru.begin());
+                if (shard.lru.size() > shard.capacity) {
+                    shard.index.erase(shard.lru.back().key);
+                    shard.lru.pop_back();
+                    ++shard.evictions;
+                }
+            }
+        }
+        return result;
+    }
+};
+
+#endif
@@ -0,0 +1,367 @@
+#ifndef FORMULA_CSE_HPP
+#define FORMULA_CSE_HPP
+
+#include <cstring>
+#include <unordered_map>
+#include "boolean_algebra.hpp"
+
+// Common-subexpression elimination for RPN formulas.
+//
+// CseFormula hash-conses the RPN into a DAG: before a node is created it is
+// looked up by (operator, operand values), so a subexpression that occurs
+// many times, like the repeated halves of the expanded equivalences ex05
+// produces, gets a single value number. Operands of the commutative operators
+// are put in order and double negations fold away first, so "AB&" and "BA&",
+// or "A!!" and "A", are the same value too.
+//
+// The DAG is then emitted as a straight-line SSA program, operands before
+// their users, with values the result does not depend on dropped. Each value
+// is computed once into a register slot, and a slot is handed to a new value
+// as soon as the last reader of the old one has run, so the scratch space
+// follows the width of the DAG rather than its size. The program evaluates one
+// assignment or 64 bit-sliced rows per call, with the column layout of
+// JitFormula, or a whole columnar table of records at once (eval_batch).
+//
+// CseProgram compiles many formulas into one DAG, so subexpressions shared
+// across formulas are computed once per input block too, and each result is
+// copied out as soon as it is computed; CseFormula is the one-formula case.
+
+enum CseOp : uint8_t { CSE_VAR, CSE_CONST, CSE_NOT, CSE_AND, CSE_OR, CSE_XOR, CSE_IMPLIES, CSE_EQUIV };
+
+// Packed bits, bit i of word w standing for record 64 * w + i
+using BitVector = std::vector<uint64_t>;
+
+// Value i of the program is op(a, b) over earlier values a and b. For CSE_VAR
+// a is the variable index (0 for 'A'), for CSE_CONST it is 0 or 1.
+struct CseInstruction {
+    CseOp op;
+    uint32_t a;
+    uint32_t b;
+};
+
+inline char cse_operator_char(CseOp op) {
+    switch (op) {
+        case CSE_AND: return '&';
+        case CSE_OR: return '|';
+        case CSE_XOR: return '^';
+        case CSE_IMPLIES: return '>';
+        case CSE_EQUIV: return '=';
+        default: return '!';
+    }
+}
+
+class CseProgram {
+public:
+    // Every formula in one DAG: a subexpression shared by several formulas
+    // is computed once for all of them
+    explicit CseProgram(const std::vector<std::string> &formulas) : CseProgram(formulas.data(), formulas.size()) {}
+
+    uint32_t variables() const { return variables_; }
+    size_t rpn_nodes() const { return rpn_nodes_; }   // operands and operators in the RPN
+    size_t slots() const { return slot_count_; }
+    size_t formulas() const { return outputs_.size(); }
+
+    // the SSA program, and the value holding each formula's result
+    const std::vector<CseInstruction> &program() const { return program_; }
+    const std::vector<uint32_t> &outputs() const { return outputs_; }
+
+    // 64 rows at once; columns must hold 26 words (one per letter), and
+    // results[k] gets the rows of formula k
+    void eval_sliced(const uint64_t *columns, uint64_t *results) const {
+        if (slot_count_ <= kStackSlots) {
+            uint64_t registers[kStackSlots];
+            run(columns, registers, results);
+            return;
+        }
+        std::vector<uint64_t> registers(slot_count_);
+        run(columns, registers.data(), results);
+    }
+
+    // one row: bit v of assignment is the value of variable 'A' + v
+    std::vector<bool> eval(uint32_t assignment) const {
+        uint64_t columns[26];
+        broadcast(assignment, columns);
+        std::vector<uint64_t> results(formulas());
+        eval_sliced(columns, results.data());
+        std::vector<bool> out(formulas());
+        for (size_t k = 0; k < out.size(); ++k) out[k] = results[k] & 1;
+        return out;
+    }
+
+    // Columnar records: variable 'A' + v of record i is bit i % 64 of
+    // assignments[v * words + i / 64], where words = (n + 63) / 64, for every
+    // v up to the last letter the formulas use. out[k] gets the n results of
+    // formula k packed the same way, with the bits past n cleared.
+    void eval_batch(const uint64_t *assignments, size_t n, std::vector<BitVector> &out) const {
+        out.resize(formulas());
+        std::vector<uint64_t *> results(formulas());
+        for (size_t k = 0; k < out.size(); ++k) {
+            out[k].assign((n + 63) / 64, 0);
+            results[k] = out[k].data();
+        }
+        eval_batch(assignments, n, results.data());
+        if (n % 64) {
+            for (BitVector &bits : out) bits.back() &= (uint64_t(1) << (n % 64)) - 1;
+        }
+    }
+
+    // "%2 = %0 & %1" style listing, one value per line
+    std::string listing() const {
+        std::string out;
+        for (size_t i = 0; i < program_.size(); ++i) {
+            const CseInstruction &in = program_[i];
+            out += "%" + std::to_string(i) + " = ";
+            if (in.op == CSE_VAR) out += static_cast<char>('A' + in.a);
+            else if (in.op == CSE_CONST) out += in.a ? '1' : '0';
+            else if (in.op == CSE_NOT) out += "!%" + std::to_string(in.a);
+            else out += "%" + std::to_string(in.a) + " " + cse_operator_char(in.op) + " %" + std::to_string(in.b);
+            out += '\n';
+        }
+        return out;
+    }
+
+protected:
+    CseProgram(const std::string *formulas, size_t count) {
+        size_t length = 0;
+        for (size_t k = 0; k < count; ++k) {
+            // same validation and error messages as eval_formula, with variables
+            throw_eval_error(eval_rpn_runtime(formulas[k], 0, true).status);
+            variables_ |= formula_variables(formulas[k]);
+            length += formulas[k].size();
+        }
+        if (length >= (size_t(1) << kIndexBits)) {
+            throw std::invalid_argument("Error: formula too long for common-subexpression elimination");
+        }
+        build(formulas, count);
+        allocate_slots();
+    }
+
+    static void broadcast(uint32_t assignment, uint64_t *columns) {
+        for (int v = 0; v < 26; ++v) {
+            columns[v] = uint64_t(0) - ((assignment >> v) & 1);
+        }
+    }
+
+    // results[k] points at the (n + 63) / 64 output words of formula k
+    void eval_batch(const uint64_t *assignments, size_t n, uint64_t *const *results) const {
+        size_t words = (n + 63) / 64;
+        if (words == 0) return;
+
+        std::vector<uint64_t> heap;
+        uint64_t stack[kStackSlots];
+        uint64_t *registers = stack;
+        if (slot_count_ * kBatchWords > kStackSlots) {
+            heap.resize(slot_count_ * kBatchWords);
+            registers = heap.data();
+        }
+        for (size_t base = 0; base < words; base += kBatchWords) {
+            size_t count = std::min(kBatchWords, words - base);
+            run_block(assignments + base, words, count, registers, results, base);
+        }
+    }
+
+private:
+    static constexpr int kIndexBits = 29;        // value numbers in a hash-consing key
+    static constexpr size_t kStackSlots = 256;   // register words kept on the stack
+    static constexpr size_t kBatchWords = 32;    // words per register in eval_batch
+    static constexpr uint8_t kOutput = CSE_EQUIV + 1;
+
+    // program_ with operands and destination as register slots, plus a
+    // kOutput step (results[dst] = slot a) right after each formula's result
+    struct Step {
+        uint8_t op;
+        uint32_t dst;
+        uint32_t a;
+        uint32_t b;
+    };
+
+    uint32_t variables_ = 0;
+    size_t rpn_nodes_ = 0;
+    size_t slot_count_ = 0;
+    std::vector<CseInstruction> program_;
+    std::vector<uint32_t> outputs_;
+    std::vector<Step> steps_;
+
+    static bool has_operands(CseOp op) { return op >= CSE_NOT; }
+    static bool is_binary(CseOp op) { return op >= CSE_AND; }
+
+    void build(const std::string *formulas, size_t count) {
+        std::vector<CseInstruction> dag;
+        std::unordered_map<uint64_t, uint32_t> table;
+        std::vector<uint32_t> stack, roots;
+
+        auto intern = [&](CseOp op, uint32_t a, uint32_t b) {
+            uint64_t key = (uint64_t(op) << (2 * kIndexBits)) | (uint64_t(a) << kIndexBits) | b;
+            auto inserted = table.emplace(key, static_cast<uint32_t>(dag.size()));
+            if (inserted.second) dag.push_back({op, a, b});
+            return inserted.first->second;
+        };
+
+        for (size_t k = 0; k < count; ++k) {
+            for (char c : formulas[k]) {
+                ++rpn_nodes_;
+                if (c >= 'A' && c <= 'Z') {
+                    stack.push_back(intern(CSE_VAR, static_cast<uint32_t>(c - 'A'), 0));
+                } else if (c == '0' || c == '1') {
+                    stack.push_back(intern(CSE_CONST, c == '1', 0));
+                } else if (c == '!') {
+                    uint32_t x = stack.back();
+                    stack.back() = dag[x].op == CSE_NOT ? dag[x].a : intern(CSE_NOT, x, 0);
+                } else {
+                    uint32_t b = stack.back(); stack.pop_back();
+                    uint32_t a = stack.back();
+                    CseOp op = CSE_AND;
+                    switch (c) {
+                        case '&': op = CSE_AND; break;
+                        case '|': op = CSE_OR; break;
+                        case '^': op = CSE_XOR; break;
+                        case '>': op = CSE_IMPLIES; break;
+                        case '=': op = CSE_EQUIV; break;
+                    }
+                    if (op != CSE_IMPLIES && a > b) std::swap(a, b);
+                    stack.back() = intern(op, a, b);
+                }
+            }
+            roots.push_back(stack.back());
+            stack.clear();
+        }
+
+        // operands always precede their users; keep what some result depends
+        // on and renumber it densely
+        std::vector<uint32_t> renumber(dag.size(), 0);
+        std::vector<bool> live(dag.size(), false);
+        for (uint32_t root : roots) live[root] = true;
+        for (size_t i = dag.size(); i-- > 0;) {
+            if (!live[i] || !has_operands(dag[i].op)) continue;
+            live[dag[i].a] = true;
+            if (is_binary(dag[i].op)) live[dag[i].b] = true;
+        }
+        for (size_t i = 0; i < dag.size(); ++i) {
+            if (!live[i]) continue;
+            CseInstruction in = dag[i];
+            if (has_operands(in.op)) in.a = renumber[in.a];
+            if (is_binary(in.op)) in.b = renumber[in.b];
+            renumber[i] = static_cast<uint32_t>(program_.size());
+            program_.push_back(in);
+        }
+        for (uint32_t root : roots) outputs_.push_back(renumber[root]);
+    }
+
+    // Linear scan over the straight-line program: a value's slot is freed at
+    // its last reader, and that reader may write its result into it, since
+    // every step reads its operands before writing. A result nothing else
+    // reads is freed as soon as it has been output.
+    void allocate_slots() {
+        size_t n = program_.size();
+        std::vector<size_t> last_use(n, 0);
+        std::vector<bool> read(n, false);
+        for (size_t i = 0; i < n; ++i) {
+            const CseInstruction &in = program_[i];
+            if (has_operands(in.op)) { last_use[in.a] = i; read[in.a] = true; }
+            if (is_binary(in.op)) { last_use[in.b] = i; read[in.b] = true; }
+        }
+        std::vector<std::vector<uint32_t>> output_of(n);
+        for (size_t k = 0; k < outputs_.size(); ++k) output_of[outputs_[k]].push_back(static_cast<uint32_t>(k));
+
+        std::vector<uint32_t> slot(n), free_slots;
+        steps_.reserve(n + outputs_.size());
+        for (size_t i = 0; i < n; ++i) {
+            const CseInstruction &in = program_[i];
+            Step step{in.op, 0, in.a, in.b};
+            if (has_operands(in.op)) {
+                step.a = slot[in.a];
+                if (last_use[in.a] == i) free_slots.push_back(slot[in.a]);
+            }
+            if (is_binary(in.op)) {
+                step.b = slot[in.b];
+                if (last_use[in.b] == i && in.b != in.a) free_slots.push_back(slot[in.b]);
+            }
+            if (free_slots.empty()) {
+                slot[i] = static_cast<uint32_t>(slot_count_++);
+            } else {
+                slot[i] = free_slots.back();
+                free_slots.pop_back();
+            }
+            step.dst = slot[i];
+            steps_.push_back(step);
+
+            for (uint32_t k : output_of[i]) steps_.push_back({kOutput, k, slot[i], 0});
+            if (!read[i]) free_slots.push_back(slot[i]);
+        }
+    }
+
+    void run(const uint64_t *columns, uint64_t *r, uint64_t *results) const {
+        for (const Step &s : steps_) {
+            switch (s.op) {
+                case CSE_VAR: r[s.dst] = columns[s.a]; break;
+                case CSE_CONST: r[s.dst] = uint64_t(0) - s.a; break;
+                case CSE_NOT: r[s.dst] = ~r[s.a]; break;
+                case CSE_AND: r[s.dst] = r[s.a] & r[s.b]; break;
+                case CSE_OR: r[s.dst] = r[s.a] | r[s.b]; break;
+                case CSE_XOR: r[s.dst] = r[s.a] ^ r[s.b]; break;
+                case CSE_IMPLIES: r[s.dst] = ~r[s.a] | r[s.b]; break;
+                case CSE_EQUIV: r[s.dst] = ~(r[s.a] ^ r[s.b]); break;
+                case kOutput: results[s.dst] = r[s.a]; break;
+            }
+        }
+    }
+
+    // Each step over `count` words of every register at once, so the dispatch
+    // is paid once per 2048 records and the word loops vectorize. Register
+    // slot k is r[k * kBatchWords, ...); column v starts at columns[v * stride].
+    void run_block(const uint64_t *columns, size_t stride, size_t count, uint64_t *r,
+                   uint64_t *const *results, size_t base) const {
+        for (const Step &s : steps_) {
+            uint64_t *d = r + s.dst * kBatchWords;
+            const uint64_t *a = r + s.a * kBatchWords;
+            const uint64_t *b = r + s.b * kBatchWords;
+            switch (s.op) {
+                case CSE_VAR: std::memcpy(d, columns + s.a * stride, count * sizeof(uint64_t)); break;
+                case CSE_CONST: std::fill(d, d + count, uint64_t(0) - s.a); break;
+                case CSE_NOT: for (size_t w = 0; w < count; ++w) d[w] = ~a[w]; break;
+                case CSE_AND: for (size_t w = 0; w < count; ++w) d[w] = a[w] & b[w]; break;
+                case CSE_OR: for (size_t w = 0; w < count; ++w) d[w] = a[w] | b[w]; break;
+                case CSE_XOR: for (size_t w = 0; w < count; ++w) d[w] = a[w] ^ b[w]; break;
+                case CSE_IMPLIES: for (size_t w = 0; w < count; ++w) d[w] = ~a[w] | b[w]; break;
+                case CSE_EQUIV: for (size_t w = 0; w < count; ++w) d[w] = ~(a[w] ^ b[w]); break;
+                case kOutput: std::memcpy(results[s.dst] + base, a, count * sizeof(uint64_t)); break;
+            }
+        }
+    }
+};
+
+// A single formula
+class CseFormula : public CseProgram {
+public:
+    explicit CseFormula(const std::string &rpn) : CseProgram(&rpn, 1) {}
+
+    // 64 rows at once; columns must hold 26 words (one per letter)
+    uint64_t eval_sliced(const uint64_t *columns) const {
+        uint64_t result;
+        CseProgram::eval_sliced(columns, &result);
+        return result;
+    }
+
+    // one row: bit v of assignment is the value of variable 'A' + v
+    bool eval(uint32_t assignment) const {
+        uint64_t columns[26];
+        broadcast(assignment, columns);
+        return eval_sliced(columns) & 1;
+    }
+
+    // CseProgram::eval_batch for the one formula
+    void eval_batch(const uint64_t *assignments, size_t n, BitVector &out) const {
+        out.assign((n + 63) / 64, 0);
+        uint64_t *result = out.data();
+        CseProgram::eval_batch(assignments, n, &result);
+        if (n % 64) out.back() &= (uint64_t(1) << (n % 64)) - 1;
+    }
+};
+
+// eval_formula over a columnar table of n records (see CseFormula::eval_batch);
+// compile a CseFormula once instead when the same formula sees several tables
+inline void eval_batch(const std::string &formula, const uint64_t *assignments, size_t n, BitVector &out) {
+    CseFormula(formula).eval_batch(assignments, n, out);
+}
+
+#endif
@@ -0,0 +1,184 @@
+#ifndef FORMULA_GENERATOR_HPP
+#define FORMULA_GENERATOR_HPP
+
+#include <random>
+#include "boolean_algebra.hpp"
+
+// Seeded random RPN formulas for fuzzing and benchmarking.
+//
+// The same seed and options always give the same sequence of formulas, so a
+// failing case can be reproduced from its seed and index alone. Formulas use
+// variables only (no 0/1 constants), the input accepted by every exercise.
+//
+//   GeneratorOptions options;
+//   options.variables = 6;
+//   options.shape = FormulaShape::XOR_HEAVY;
+//   FormulaGenerator gen(42, options);
+//   std::string f = gen.next();
+
+enum class FormulaShape {
+    RANDOM,         // full tree, all five binary operators equally likely
+    XOR_HEAVY,      // mostly ^ and =, the worst case for NNF/CNF expansion
+    CNF_LIKE,       // conjunction of `clauses` disjunctions of `clause_width` literals
+    DEEP_CHAIN      // left-deep chain of `depth` operators, one new operand per step
+};
+
+struct GeneratorOptions {
+    int variables = 4;              // letters A.. in use, 1 to 26
+    int depth = 4;                  // tree depth, or chain length for DEEP_CHAIN
+    FormulaShape shape = FormulaShape::RANDOM;
+    int clauses = 4;                // CNF_LIKE only
+    int clause_width = 3;           // CNF_LIKE only
+    double negation_rate = 0.2;     // chance of a '!' after any node
+    double leaf_rate = 0.2;         // chance a subtree stops before full depth
+    double sat_ratio = -1.0;        // wanted fraction of satisfiable formulas, < 0 for any
+};
+
+inline const char *formula_shape_name(FormulaShape shape) {
+    switch (shape) {
+        case FormulaShape::RANDOM: return "random";
+        case FormulaShape::XOR_HEAVY: return "xor_heavy";
+        case FormulaShape::CNF_LIKE: return "cnf_like";
+        case FormulaShape::DEEP_CHAIN: return "deep_chain";
+    }
+    return "unknown";
+}
+
+inline FormulaShape parse_formula_shape(const std::string &name) {
+    for (FormulaShape shape : {FormulaShape::RANDOM, FormulaShape::XOR_HEAVY,
+                               FormulaShape::CNF_LIKE, FormulaShape::DEEP_CHAIN}) {
+        if (name == formula_shape_name(shape)) return shape;
+    }
+    throw std::invalid_argument("Error: unknown formula shape: " + name);
+}
+
+// Truth table of `expression` over the variables in `variables`, one bit per
+// row in print_truth_table's row order. Evaluated with eval_formula's core,
+// so other formulas over the same variables can be compared bit for bit.
+inline std::vector<uint64_t> formula_truth_table_bits(std::string_view expression, uint32_t variables) {
+    int n = count_variables(variables);
+    uint64_t rows = uint64_t(1) << n;
+    std::vector<uint64_t> table((rows + 63) / 64, 0);
+
+    for (uint64_t row = 0; row < rows; ++row) {
+        EvalResult result = eval_rpn_runtime(expression, row_assignment(variables, n, row), true);
+        throw_eval_error(result.status);
+        if (result.value) table[row / 64] |= uint64_t(1) << (row % 64);
+    }
+    return table;
+}
+
+class FormulaGenerator {
+public:
+    // satisfiability is decided by brute force, so sat_ratio is limited to
+    // formulas of at most this many variables
+    static constexpr int kMaxSatVariables = 20;
+
+    explicit FormulaGenerator(uint64_t seed, GeneratorOptions options = {})
+        : rng_(seed), options_(options) {
+        if (options_.variables < 1 || options_.variables > 26) {
+            throw std::invalid_argument("Error: generator variables must be between 1 and 26");
+        }
+        if (options_.depth < 0 || options_.clauses < 1 || options_.clause_width < 1) {
+            throw std::invalid_argument("Error: generator depth, clauses and clause width must be positive");
+        }
+        if (options_.sat_ratio >= 0 && options_.variables > kMaxSatVariables) {
+            throw std::invalid_argument("Error: sat_ratio needs at most 20 variables");
+        }
+    }
+
+    const GeneratorOptions &options() const { return options_; }
+
+    std::string next() {
+        if (options_.sat_ratio < 0) return generate();
+
+        // draw the wanted outcome, then resample until a formula matches;
+        // when the shape makes that unlikely, adjust the last attempt
+        bool want = chance(options_.sat_ratio);
+        std::string f;
+        for (int attempt = 0; attempt < 64; ++attempt) {
+            f = generate();
+            if (satisfiable(f) == want) return f;
+        }
+        char v = variable();
+        if (want) return f + v + '|';                           // f | v holds with v = 1
+        return f + v + v + '!' + '&' + '&';                     // f & (v & !v) never holds
+    }
+
+private:
+    std::mt19937_64 rng_;
+    GeneratorOptions options_;
+
+    bool chance(double p) {
+        return std::uniform_real_distribution<double>(0.0, 1.0)(rng_) < p;
+    }
+
+    char variable() {
+        return static_cast<char>('A' + rng_() % options_.variables);
+    }
+
+    char random_operator() {
+        static const char ops[] = "&|^>=";
+        if (options_.shape == FormulaShape::XOR_HEAVY && chance(0.8)) {
+            return (rng_() & 1) ? '^' : '=';
+        }
+        return ops[rng_() % 5];
+    }
+
+    void maybe_negate(std::string &out) {
+        if (chance(options_.negation_rate)) out += '!';
+    }
+
+    void tree(std::string &out, int depth) {
+        if (depth == 0 || (depth < options_.depth && chance(options_.leaf_rate))) {
+            out += variable();
+        } else {
+            tree(out, depth - 1);
+            tree(out, depth - 1);
+            out += random_operator();
+        }
+        maybe_negate(out);
+    }
+
+    std::string generate() {
+        std::string out;
+
+        switch (options_.shape) {
+            case FormulaShape::RANDOM:
+            case FormulaShape::XOR_HEAVY:
+                tree(out, options_.depth);
+                break;
+
+            case FormulaShape::DEEP_CHAIN:
+                out += variable();
+                for (int i = 0; i < options_.depth; ++i) {
+                    out += variable();
+                    maybe_negate(out);
+                    out += random_operator();
+                    maybe_negate(out);
+                }
+                break;
+
+            case FormulaShape::CNF_LIKE:
+                for (int c = 0; c < options_.clauses; ++c) {
+                    for (int l = 0; l < options_.clause_width; ++l) {
+                        out += variable();
+                        if (rng_() & 1) out += '!';
+                        if (l > 0) out += '|';
+                    }
+                    if (c > 0) out += '&';
+                }
+                break;
+        }
+        return out;
+    }
+
+    static bool satisfiable(const std::string &f) {
+        for (uint64_t word : formula_truth_table_bits(f, formula_variables(f))) {
+            if (word) return true;
+        }
+        return false;
+    }
+};
+
+#endif
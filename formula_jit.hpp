@@ -0,0 +1,256 @@
+#ifndef FORMULA_JIT_HPP
+#define FORMULA_JIT_HPP
+
+#include <cstring>
+#include "boolean_algebra.hpp"
+
+#if defined(__x86_64__) && defined(__unix__)
+#include <sys/mman.h>
+#define FORMULA_JIT_NATIVE 1
+#else
+#define FORMULA_JIT_NATIVE 0
+#endif
+
+// Runtime compilation of RPN formulas to native x86-64 code.
+//
+// The generated function evaluates 64 assignments at once: it takes one
+// 64-bit column per variable (bit i of columns[v] is the value of variable
+// 'A' + v in row i) and returns the 64 results packed the same way. Each RPN
+// stack depth is given a fixed register, so every push, operator and
+// negation becomes one or two instructions; depths beyond the available
+// registers spill to a stack frame. On other architectures, or when
+// executable memory cannot be mapped, the same columns are evaluated by a
+// bit-sliced interpreter.
+
+using JitFunction = uint64_t (*)(const uint64_t *columns);
+
+class JitFormula {
+public:
+    explicit JitFormula(const std::string &rpn) : rpn_(rpn) {
+        // same validation and error messages as eval_formula, with variables
+        throw_eval_error(eval_rpn_runtime(rpn_, 0, true).status);
+        variables_ = formula_variables(rpn_);
+#if FORMULA_JIT_NATIVE
+        compile();
+#endif
+    }
+
+    ~JitFormula() { release(); }
+
+    JitFormula(const JitFormula &) = delete;
+    JitFormula &operator=(const JitFormula &) = delete;
+
+    JitFormula(JitFormula &&other) noexcept
+        : rpn_(std::move(other.rpn_)), variables_(other.variables_),
+          code_(other.code_), code_size_(other.code_size_), function_(other.function_) {
+        other.code_ = nullptr;
+        other.function_ = nullptr;
+    }
+
+    JitFormula &operator=(JitFormula &&other) noexcept {
+        if (this != &other) {
+            release();
+            rpn_ = std::move(other.rpn_);
+            variables_ = other.variables_;
+            code_ = other.code_;
+            code_size_ = other.code_size_;
+            function_ = other.function_;
+            other.code_ = nullptr;
+            other.function_ = nullptr;
+        }
+        return *this;
+    }
+
+    bool is_native() const { return function_ != nullptr; }
+    uint32_t variables() const { return variables_; }
+
+    // 64 rows at once; columns must hold 26 words (one per letter)
+    uint64_t eval_sliced(const uint64_t *columns) const {
+        if (function_) return function_(columns);
+        return interpret(columns);
+    }
+
+    // one row: bit v of assignment is the value of variable 'A' + v
+    bool eval(uint32_t assignment) const {
+        uint64_t columns[26];
+        for (int v = 0; v < 26; ++v) {
+            columns[v] = uint64_t(0) - ((assignment >> v) & 1);
+        }
+        return eval_sliced(columns) & 1;
+    }
+
+private:
+    std::string rpn_;
+    uint32_t variables_ = 0;
+    void *code_ = nullptr;
+    size_t code_size_ = 0;
+    JitFunction function_ = nullptr;
+
+    void release() {
+#if FORMULA_JIT_NATIVE
+        if (code_) ::munmap(code_, code_size_);
+#endif
+        code_ = nullptr;
+        function_ = nullptr;
+    }
+
+    uint64_t interpret(const uint64_t *columns) const {
+        std::vector<uint64_t> stack;
+        stack.reserve(rpn_.size());
+
+        for (char c : rpn_) {
+            if (c >= 'A' && c <= 'Z') {
+                stack.push_back(columns[c - 'A']);
+            } else if (c == '0' || c == '1') {
+                stack.push_back(c == '1' ? ~uint64_t(0) : 0);
+            } else if (c == '!') {
+                stack.back() = ~stack.back();
+            } else {
+                uint64_t b = stack.back(); stack.pop_back();
+                uint64_t &a = stack.back();
+                switch (c) {
+                    case '&': a &= b; break;
+                    case '|': a |= b; break;
+                    case '^': a ^= b; break;
+                    case '>': a = ~a | b; break;
+                    case '=': a = ~(a ^ b); break;
+                }
+            }
+        }
+        return stack.back();
+    }
+
+#if FORMULA_JIT_NATIVE
+    // RPN stack depth d lives in kSlotRegs[d]; deeper entries live in
+    // [rsp + 8 * (d - kRegSlots)]. r11 is scratch, rdi holds `columns`.
+    static constexpr int kRegSlots = 7;
+    static constexpr uint8_t kSlotRegs[kRegSlots] = {0 /*rax*/, 1 /*rcx*/, 2 /*rdx*/, 6 /*rsi*/,
+                                                     8 /*r8*/, 9 /*r9*/, 10 /*r10*/};
+    static constexpr uint8_t kScratch = 11;   // r11
+    static constexpr uint8_t kRdi = 7;
+    static constexpr uint8_t kRsp = 4;
+
+    struct Emitter {
+        std::vector<uint8_t> code;
+
+        void byte(uint8_t b) { code.push_back(b); }
+        void imm32(uint32_t v) {
+            for (int i = 0; i < 4; ++i) byte(static_cast<uint8_t>(v >> (8 * i)));
+        }
+        void rex(uint8_t reg, uint8_t rm) {
+            byte(static_cast<uint8_t>(0x48 | ((reg >> 3) << 2) | (rm >> 3)));
+        }
+        void modrm(uint8_t mod, uint8_t reg, uint8_t rm) {
+            byte(static_cast<uint8_t>((mod << 6) | ((reg & 7) << 3) | (rm & 7)));
+        }
+        // [base + disp32] operand; rsp as base needs a SIB byte
+        void mem(uint8_t reg, uint8_t base, uint32_t disp) {
+            modrm(2, reg, base);
+            if ((base & 7) == kRsp) byte(0x24);
+            imm32(disp);
+        }
+
+        // opcode reg, [base + disp] / opcode [base + disp], reg
+        void op_mem(uint8_t opcode, uint8_t reg, uint8_t base, uint32_t disp) {
+            rex(reg, base); byte(opcode); mem(reg, base, disp);
+        }
+        // opcode dst, src with the r/m form (dst in r/m, src in reg)
+        void op_reg(uint8_t opcode, uint8_t dst, uint8_t src) {
+            rex(src, dst); byte(opcode); modrm(3, src, dst);
+        }
+        void not_reg(uint8_t r) { rex(0, r); byte(0xF7); modrm(3, 2, r); }
+        void not_mem(uint32_t disp) { rex(0, kRsp); byte(0xF7); mem(2, kRsp, disp); }
+        void mov_imm_reg(uint8_t r, uint32_t imm) { rex(0, r); byte(0xC7); modrm(3, 0, r); imm32(imm); }
+        void mov_imm_mem(uint32_t disp, uint32_t imm) { rex(0, kRsp); byte(0xC7); mem(0, kRsp, disp); imm32(imm); }
+    };
+
+    static bool in_reg(int depth) { return depth < kRegSlots; }
+    static uint32_t spill_disp(int depth) { return static_cast<uint32_t>(8 * (depth - kRegSlots)); }
+
+    void compile() {
+        // deepest stack use decides the spill frame size
+        int depth = 0, max_depth = 0;
+        for (char c : rpn_) {
+            if ((c >= 'A' && c <= 'Z') || c == '0' || c == '1') max_depth = std::max(max_depth, ++depth);
+            else if (c != '!') --depth;
+        }
+        uint32_t frame = max_depth > kRegSlots ? static_cast<uint32_t>(8 * (max_depth - kRegSlots)) : 0;
+
+        Emitter e;
+        if (frame) { e.byte(0x48); e.byte(0x81); e.modrm(3, 5, kRsp); e.imm32(frame); }   // sub rsp, frame
+
+        depth = 0;
+        for (char c : rpn_) {
+            if ((c >= 'A' && c <= 'Z') || c == '0' || c == '1') {
+                bool is_var = c >= 'A';
+                uint32_t imm = (c == '1') ? 0xFFFFFFFFu : 0;   // sign-extends to all ones
+                if (in_reg(depth)) {
+                    uint8_t r = kSlotRegs[depth];
+                    if (is_var) e.op_mem(0x8B, r, kRdi, static_cast<uint32_t>(8 * (c - 'A')));
+                    else e.mov_imm_reg(r, imm);
+                } else if (is_var) {
+                    e.op_mem(0x8B, kScratch, kRdi, static_cast<uint32_t>(8 * (c - 'A')));
+                    e.op_mem(0x89, kScratch, kRsp, spill_disp(depth));
+                } else {
+                    e.mov_imm_mem(spill_disp(depth), imm);
+                }
+                ++depth;
+                continue;
+            }
+
+            if (c == '!') {
+                if (in_reg(depth - 1)) e.not_reg(kSlotRegs[depth - 1]);
+                else e.not_mem(spill_disp(depth - 1));
+                continue;
+            }
+
+            int a = depth - 2, b = depth - 1;
+            uint8_t src;
+            if (in_reg(b)) {
+                src = kSlotRegs[b];
+            } else {
+                e.op_mem(0x8B, kScratch, kRsp, spill_disp(b));
+                src = kScratch;
+            }
+
+            // binary op on slot a with src: and 0x21, or 0x09, xor 0x31
+            auto apply = [&](uint8_t opcode) {
+                if (in_reg(a)) e.op_reg(opcode, kSlotRegs[a], src);
+                else e.op_mem(opcode, src, kRsp, spill_disp(a));
+            };
+            auto negate_a = [&]() {
+                if (in_reg(a)) e.not_reg(kSlotRegs[a]);
+                else e.not_mem(spill_disp(a));
+            };
+
+            switch (c) {
+                case '&': apply(0x21); break;
+                case '|': apply(0x09); break;
+                case '^': apply(0x31); break;
+                case '>': negate_a(); apply(0x09); break;
+                case '=': apply(0x31); negate_a(); break;
+            }
+            --depth;
+        }
+
+        if (frame) { e.byte(0x48); e.byte(0x81); e.modrm(3, 0, kRsp); e.imm32(frame); }  // add rsp, frame
+        e.byte(0xC3);   // ret: the result is slot 0, rax
+
+        size_t page = 4096;
+        size_t size = (e.code.size() + page - 1) / page * page;
+        void *memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) return;   // interpreter fallback
+
+        std::memcpy(memory, e.code.data(), e.code.size());
+        if (::mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+            ::munmap(memory, size);
+            return;
+        }
+        code_ = memory;
+        code_size_ = size;
+        function_ = reinterpret_cast<JitFunction>(memory);
+    }
+#endif
+};
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef FORMULA_TEMPLATE_HPP
+#define FORMULA_TEMPLATE_HPP
+
+#include <type_traits>
+#include "boolean_algebra.hpp"
+
+#if !defined(__cpp_nontype_template_args) || __cpp_nontype_template_args < 201911L
+#error "formula_template.hpp needs C++20 (class-type template parameters)"
+#endif
+
+// Formulas fixed at build time, expanded into straight-line code.
+//
+// Formula<"AB&C|"> parses its RPN in a constant expression and instantiates
+// one function per node, so eval() inlines down to the formula's bitwise
+// operations with no interpreter loop, stack or branches:
+//
+//   bool r = Formula<"AB&C|">::eval(a, b, c);
+//   uint64_t r64 = Formula<"AB&C|">::eval(a64, b64, c64);   // 64 rows at once
+//
+// Arguments are the formula's variables in alphabetical order. With integer
+// arguments every bit is an independent row (bit-sliced evaluation).
+
+template <typename T>
+constexpr T formula_not(T value) {
+    if constexpr (std::is_same_v<T, bool>) return !value;
+    else return static_cast<T>(~value);
+}
+
+template <typename T>
+constexpr T formula_all_ones() {
+    return formula_not(T(0));
+}
+
+template <fixed_string F>
+struct Formula {
+    static constexpr FixedFormula<F.length> tree = parse_fixed_rpn<F.length>(F.view(), true);
+    static constexpr int arity = count_variables(tree.variables);
+
+    // position of variable `c` in eval's argument list
+    static constexpr int argument_index(char c) {
+        return count_variables(tree.variables & ((uint32_t(1) << (c - 'A')) - 1));
+    }
+
+    template <int I, typename T>
+    static constexpr T node(const T *values) {
+        constexpr FixedNode n = tree.nodes[I];
+
+        if constexpr (n.op == '!') {
+            return formula_not(node<n.right>(values));
+        } else if constexpr (n.op == '&') {
+            return node<n.left>(values) & node<n.right>(values);
+        } else if constexpr (n.op == '|') {
+            return node<n.left>(values) | node<n.right>(values);
+        } else if constexpr (n.op == '^') {
+            return node<n.left>(values) ^ node<n.right>(values);
+        } else if constexpr (n.op == '>') {
+            return formula_not(node<n.left>(values)) | node<n.right>(values);
+        } else if constexpr (n.op == '=') {
+            return formula_not(static_cast<T>(node<n.left>(values) ^ node<n.right>(values)));
+        } else if constexpr (n.op == '0') {
+            return T(0);
+        } else if constexpr (n.op == '1') {
+            return formula_all_ones<T>();
+        } else {
+            return values[argument_index(n.op)];
+        }
+    }
+
+    template <typename T, typename... Args>
+    static constexpr T eval(T first, Args... rest) {
+        static_assert(1 + sizeof...(Args) == arity, "Formula::eval takes one argument per variable");
+        static_assert(std::is_same_v<T, bool> || std::is_unsigned_v<T>,
+                      "Formula::eval takes bool or unsigned bit-sliced arguments");
+        const T values[arity] = {first, static_cast<T>(rest)...};
+        return node<tree.root>(values);
+    }
+
+    // formulas made only of constants
+    static constexpr bool eval() {
+        static_assert(arity == 0, "Formula::eval takes one argument per variable");
+        return node<tree.root, bool>(nullptr);
+    }
+
+    // variable values as bits of an assignment word (bit v = variable 'A' + v),
+    // the convention of eval_rpn
+    static constexpr bool eval_assignment(uint32_t assignment) {
+        bool values[arity + 1] = {};
+        for (int v = 0; v < 26; ++v) {
+            if ((tree.variables >> v) & 1) {
+                values[argument_index(static_cast<char>('A' + v))] = (assignment >> v) & 1;
+            }
+        }
+        return node<tree.root>(static_cast<const bool *>(values));
+    }
+};
+
+#endif
@@ -0,0 +1,221 @@
+// differential fuzzing of NNF / CNF / SAT against brute-force truth tables
+//
+// ./fuzz                                   default corpus, summary per shape
+// ./fuzz --cases 500 --seed 7              larger run from another seed
+// ./fuzz --csv timings.csv                 one timing row per case
+// ./fuzz --corpus deep_chain 1000          print formulas (for ./batch) and exit
+
+#include <chrono>
+#include <fstream>
+#include "../formula_generator.hpp"
+
+struct CorpusConfig {
+    const char *name;
+    GeneratorOptions options;
+};
+
+// sized so that CNF's distribution stays in the milliseconds per formula
+static std::vector<CorpusConfig> default_corpus() {
+    std::vector<CorpusConfig> corpus(4);
+
+    corpus[0].name = "random";
+    corpus[0].options.variables = 5;
+    corpus[0].options.depth = 3;
+
+    corpus[1].name = "xor_heavy";
+    corpus[1].options.shape = FormulaShape::XOR_HEAVY;
+    corpus[1].options.variables = 4;
+    corpus[1].options.depth = 3;
+
+    corpus[2].name = "cnf_like";
+    corpus[2].options.shape = FormulaShape::CNF_LIKE;
+    corpus[2].options.variables = 8;
+    corpus[2].options.clauses = 24;
+    corpus[2].options.clause_width = 3;
+    corpus[2].options.sat_ratio = 0.5;
+
+    corpus[3].name = "deep_chain";
+    corpus[3].options.shape = FormulaShape::DEEP_CHAIN;
+    corpus[3].options.variables = 6;
+    corpus[3].options.depth = 4;
+
+    return corpus;
+}
+
+// only variables, negations directly on variables, & and |
+static bool is_nnf(const std::string &f) {
+    // a formula the simplifier folded to a constant
+    if (f == "0" || f == "1") return true;
+    for (size_t i = 0; i < f.size(); ++i) {
+        char c = f[i];
+        if (c >= 'A' && c <= 'Z') continue;
+        if (c == '&' || c == '|') continue;
+        if (c == '!' && i > 0 && f[i - 1] >= 'A' && f[i - 1] <= 'Z') continue;
+        return false;
+    }
+    return true;
+}
+
+// NNF with no conjunction below a disjunction
+static bool is_cnf(const std::string &f) {
+    if (!is_nnf(f)) return false;
+    std::vector<bool> has_and;
+    for (char c : f) {
+        if (c >= 'A' && c <= 'Z') {
+            has_and.push_back(false);
+        } else if (c == '&' || c == '|') {
+            bool right = has_and.back(); has_and.pop_back();
+            bool left = has_and.back(); has_and.pop_back();
+            if (c == '|' && (left || right)) return false;
+            has_and.push_back(c == '&' || left || right);
+        }
+    }
+    return true;
+}
+
+struct CaseResult {
+    bool ok = true;
+    std::string failure;
+    double nnf_us = 0, cnf_us = 0, sat_us = 0;
+    size_t cnf_length = 0;
+    bool satisfiable = false;
+};
+
+template <typename F>
+static auto timed(double &micros, F &&f) {
+    auto start = std::chrono::steady_clock::now();
+    auto result = f();
+    micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+static CaseResult run_case(const std::string &f) {
+    CaseResult r;
+    uint32_t variables = formula_variables(f);
+    std::vector<uint64_t> expected = formula_truth_table_bits(f, variables);
+
+    std::string nnf = timed(r.nnf_us, [&] { return negation_normal_form(f); });
+    if (!is_nnf(nnf)) {
+        r.ok = false; r.failure = "NNF not in normal form: " + nnf;
+    } else if (formula_truth_table_bits(nnf, variables) != expected) {
+        r.ok = false; r.failure = "NNF not equivalent: " + nnf;
+    }
+
+    std::string cnf = timed(r.cnf_us, [&] { return conjunctive_normal_form(f); });
+    r.cnf_length = cnf.size();
+    if (r.ok && !is_cnf(cnf)) {
+        r.ok = false; r.failure = "CNF not in normal form: " + cnf;
+    } else if (r.ok && formula_truth_table_bits(cnf, variables) != expected) {
+        r.ok = false; r.failure = "CNF not equivalent: " + cnf;
+    }
+
+    r.satisfiable = false;
+    for (uint64_t word : expected) r.satisfiable |= word != 0;
+    bool result = timed(r.sat_us, [&] { return sat(f); });
+    if (r.ok && result != r.satisfiable) {
+        r.ok = false; r.failure = std::string("SAT returned ") + (result ? "true" : "false");
+    }
+    return r;
+}
+
+struct ShapeSummary {
+    int cases = 0, satisfiable = 0;
+    double nnf_us = 0, cnf_us = 0, sat_us = 0, cnf_max_us = 0;
+};
+
+static void usage() {
+    std::cerr << "usage: ./fuzz [--cases N] [--seed S] [--csv FILE]\n"
+                 "       ./fuzz --corpus <random|xor_heavy|cnf_like|deep_chain> N [--seed S]" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    int cases = 50;
+    uint64_t seed = 42;
+    std::string csv_path, corpus_shape;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--cases" && i + 1 < argc) {
+            cases = std::stoi(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::stoull(argv[++i]);
+        } else if (arg == "--csv" && i + 1 < argc) {
+            csv_path = argv[++i];
+        } else if (arg == "--corpus" && i + 2 < argc) {
+            corpus_shape = argv[++i];
+            cases = std::stoi(argv[++i]);
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    std::vector<CorpusConfig> corpus = default_corpus();
+
+    if (!corpus_shape.empty()) {
+        FormulaShape shape;
+        try {
+            shape = parse_formula_shape(corpus_shape);
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << std::endl;
+            usage();
+            return 2;
+        }
+        for (const CorpusConfig &config : corpus) {
+            if (config.options.shape != shape) continue;
+            FormulaGenerator gen(seed, config.options);
+            for (int i = 0; i < cases; ++i) std::cout << gen.next() << '\n';
+        }
+        return 0;
+    }
+
+    std::ofstream csv;
+    if (!csv_path.empty()) {
+        csv.open(csv_path);
+        csv << "shape,index,variables,length,cnf_length,satisfiable,nnf_us,cnf_us,sat_us\n";
+    }
+
+    std::cout << "\033[0;33mDifferential Fuzzing (seed " << seed << ", " << cases
+              << " cases per shape)------\033[0m" << std::endl;
+
+    int failures = 0;
+    for (const CorpusConfig &config : corpus) {
+        FormulaGenerator gen(seed, config.options);
+        ShapeSummary summary;
+
+        for (int i = 0; i < cases; ++i) {
+            std::string f = gen.next();
+            CaseResult r = run_case(f);
+
+            if (!r.ok) {
+                ++failures;
+                std::cout << "\033[0;31m✗ " << config.name << " #" << i << " (seed " << seed
+                          << "): " << f << "\n  " << r.failure << "\033[0m" << std::endl;
+            }
+            ++summary.cases;
+            summary.satisfiable += r.satisfiable;
+            summary.nnf_us += r.nnf_us;
+            summary.cnf_us += r.cnf_us;
+            summary.sat_us += r.sat_us;
+            summary.cnf_max_us = std::max(summary.cnf_max_us, r.cnf_us);
+
+            if (csv.is_open()) {
+                csv << config.name << ',' << i << ',' << count_variables(formula_variables(f)) << ','
+                    << f.size() << ',' << r.cnf_length << ',' << r.satisfiable << ','
+                    << r.nnf_us << ',' << r.cnf_us << ',' << r.sat_us << '\n';
+            }
+        }
+
+        std::cout << config.name << ": " << summary.satisfiable << "/" << summary.cases << " satisfiable"
+                  << ", mean NNF " << summary.nnf_us / summary.cases << " us"
+                  << ", CNF " << summary.cnf_us / summary.cases << " us (max " << summary.cnf_max_us << ")"
+                  << ", SAT " << summary.sat_us / summary.cases << " us" << std::endl;
+    }
+
+    if (failures) {
+        std::cout << "\033[0;31m" << failures << " failing cases\033[0m" << std::endl;
+        return 1;
+    }
+    std::cout << "\033[0;32m✓ NNF, CNF and SAT agree with the truth tables on every case\033[0m" << std::endl;
+    return 0;
+}
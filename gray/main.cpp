@@ -0,0 +1,244 @@
+// Gray-code main
+
+#include <cassert>
+#include <random>
+#include "../boolean_algebra.hpp"
+#include "../formula_generator.hpp"
+
+void test_gray_walk() {
+    std::cout << "\033[0;33mGray Order Evaluation Tests---------------\033[0m" << std::endl;
+
+    std::string order;
+    for_each_gray_assignment("AB&C|", [&](uint64_t row, uint32_t assignment, bool value) {
+        assert(assignment == row_assignment(0b111, 3, row));
+        order += std::to_string(row) + (value ? "+ " : "- ");
+        return true;
+    });
+    std::cout << "AB&C|: " << order << std::endl;
+    assert(order == "0- 1+ 3+ 2- 6+ 7+ 5+ 4- ");
+    std::cout << "\033[0;32m✓ Rows in Gray order\033[0m" << std::endl;
+
+    // every row once, one variable per step, values as eval_formula's
+    int cases = 0;
+    for (int variables : {1, 4, 8, 12}) {
+        GeneratorOptions options;
+        options.variables = variables;
+        options.depth = 7;
+        FormulaGenerator gen(static_cast<uint64_t>(variables) + 40, options);
+        for (int i = 0; i < 25; ++i, ++cases) {
+            std::string f = gen.next();
+            uint32_t mask = formula_variables(f);
+            int n = count_variables(mask);
+            std::vector<bool> seen(size_t(1) << n, false);
+            uint32_t previous = 0;
+            bool first = true;
+            for_each_gray_assignment(f, [&](uint64_t row, uint32_t assignment, bool value) {
+                assert(!seen[row]);
+                seen[row] = true;
+                assert(assignment == row_assignment(mask, n, row));
+                assert(first || count_variables(assignment ^ previous) == 1);
+                assert(value == eval_rpn_runtime(f, assignment, true).value);
+                previous = assignment;
+                first = false;
+                return true;
+            });
+            assert(std::find(seen.begin(), seen.end(), false) == seen.end());
+        }
+    }
+    std::cout << cases << " generated formulas" << std::endl;
+    std::cout << "\033[0;32m✓ Incremental values match eval_formula on every row\033[0m" << std::endl;
+}
+
+void test_cone_cost() {
+    std::cout << "\n\033[0;33mGray Order Cost Tests---------------------\033[0m" << std::endl;
+
+    // twenty independent clauses, each a deep subformula of two variables:
+    // a flip touches at most two clauses and the spine above them
+    GeneratorOptions options;
+    options.variables = 2;
+    options.depth = 6;
+    FormulaGenerator gen(77, options);
+    std::string f;
+    for (int c = 0; c < 20; ++c) {
+        std::string clause = gen.next();
+        for (char &ch : clause) {
+            if (ch >= 'A' && ch <= 'Z') ch = static_cast<char>('A' + (ch - 'A' + c) % 20);
+        }
+        f += clause;
+        if (c > 0) f += '|';
+    }
+    GrayEvaluator evaluator(f);
+    uint64_t steps = 0;
+    for_each_gray_assignment(f, [&](uint64_t, uint32_t, bool) { ++steps; return true; });
+    for (uint64_t k = 1; k < steps; ++k) evaluator.flip(__builtin_ctzll(k));
+    double per_step = static_cast<double>(evaluator.evaluations()) / static_cast<double>(steps - 1);
+    std::cout << "20 variables, " << f.size() << " nodes: " << per_step << " nodes recomputed per row" << std::endl;
+    assert(per_step * 4 < static_cast<double>(f.size()));
+
+    // sat stops at the first satisfying row
+    assert(sat("AB&C|") && !sat("AA!&") && sat("1") && !sat("0") && !sat("AB&A!&"));
+    std::cout << "\033[0;32m✓ Per-row cost follows the changed cone\033[0m" << std::endl;
+}
+
+// constexpr, and the inverse of each other
+static_assert(gray_encode(5u) == 7u && gray_decode(7u) == 5u, "3-bit Gray code");
+static_assert(gray_decode(gray_encode(~uint64_t(0))) == ~uint64_t(0), "64-bit round trip");
+
+template <typename UInt>
+void check_batch(uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    for (size_t n : {size_t(0), size_t(1), size_t(3), size_t(7), size_t(8), size_t(9), size_t(16), size_t(17), size_t(31), size_t(1000)}) {
+        std::vector<UInt> values(n), encoded(n), decoded(n), portable(n);
+        for (UInt &v : values) v = static_cast<UInt>(rng());
+        gray_encode(values.data(), encoded.data(), n);
+        gray_encode_portable(values.data(), portable.data(), n);
+        assert(encoded == portable);
+        gray_decode(encoded.data(), decoded.data(), n);
+        gray_decode_portable(encoded.data(), portable.data(), n);
+        assert(decoded == portable && decoded == values);
+        for (size_t i = 0; i < n; ++i) assert(encoded[i] == gray_encode(values[i]));
+
+        // in place
+        gray_encode(values.data(), values.data(), n);
+        assert(values == encoded);
+    }
+}
+
+void test_encode_decode() {
+    std::cout << "\n\033[0;33mGray Encode / Decode Tests----------------\033[0m" << std::endl;
+
+    // the same codes as gray_code for non-negative ints, one bit apart
+    for (uint32_t i = 0; i < 1024; ++i) {
+        assert(gray_encode(i) == static_cast<uint32_t>(gray_code(static_cast<int>(i))));
+        assert(gray_decode(gray_encode(i)) == i);
+        if (i > 0) assert(count_variables(gray_encode(i) ^ gray_encode(i - 1)) == 1);
+    }
+    // what was a negative int is an ordinary unsigned word
+    uint32_t minus_one = static_cast<uint32_t>(-1);
+    assert(gray_encode(minus_one) == 0x80000000u && gray_decode(0x80000000u) == minus_one);
+
+    check_batch<uint32_t>(1);
+    check_batch<uint64_t>(2);
+    std::cout << "batch kernels: " << (gray_code_uses_avx2() ? "AVX2" : "portable") << std::endl;
+    std::cout << "\033[0;32m✓ Batch encode and decode match the scalar functions\033[0m" << std::endl;
+}
+
+// every step one bit away, every code once, flips reported as the code moves
+std::vector<uint64_t> walk(const GraySequence &sequence, uint64_t start, uint64_t count) {
+    std::vector<uint64_t> codes;
+    GrayCursor cursor(sequence, start, count);
+    GrayStep step;
+    while (cursor.next(step)) {
+        assert(step.index == (start + codes.size()) % sequence.size() && step.code == sequence.code(step.index));
+        if (codes.empty()) assert(step.flipped == -1);
+        else assert(step.flipped >= 0 && (codes.back() ^ step.code) == uint64_t(1) << step.flipped);
+        codes.push_back(step.code);
+    }
+    assert(codes.size() == count);
+    return codes;
+}
+
+void check_sequence(const GraySequence &sequence) {
+    std::vector<uint64_t> codes = walk(sequence, 0, sequence.size());
+    std::vector<uint64_t> sorted(codes);
+    std::sort(sorted.begin(), sorted.end());
+    for (uint64_t i = 0; i < sorted.size(); ++i) assert(sorted[i] == i);
+    if (sequence.cyclic() && sequence.size() > 1) {
+        assert(count_variables(static_cast<uint32_t>(codes.back() ^ codes.front())) == 1);
+    }
+
+    // chunks put back together are the sequence
+    for (uint64_t parts : {1, 3, 7, 1000}) {
+        std::vector<uint64_t> joined;
+        for (const GrayRange &r : sequence.split(parts)) {
+            std::vector<uint64_t> chunk = walk(sequence, r.start, r.count);
+            joined.insert(joined.end(), chunk.begin(), chunk.end());
+        }
+        assert(joined == codes);
+    }
+
+    // only a cycle can be walked past its end
+    bool threw = false;
+    try {
+        walk(sequence, 0, sequence.size() + 1);
+    } catch (const std::invalid_argument &) {
+        threw = true;
+    }
+    assert(threw != sequence.cyclic());
+}
+
+void test_sequences() {
+    std::cout << "\n\033[0;33mGray Sequence Tests-----------------------\033[0m" << std::endl;
+
+    for (int bits = 0; bits <= 12; ++bits) {
+        for (GrayOrder order : {GRAY_REFLECTED, GRAY_BALANCED, GRAY_MONOTONE}) check_sequence(GraySequence(bits, order));
+    }
+    std::cout << "\033[0;32m✓ Reflected, balanced and monotone orders visit every code one bit apart\033[0m" << std::endl;
+
+    // offsets wrap around the cycle
+    GraySequence reflected(4);
+    std::vector<uint64_t> wrapped = walk(reflected, 14, 5);
+    assert((wrapped == std::vector<uint64_t>{9, 8, 0, 1, 3}));
+    GrayCursor cursor(reflected, 15, 2);
+    GrayStep step;
+    cursor.next(step);
+    cursor.next(step);
+    assert(step.index == 0 && step.flipped == 3);
+    std::vector<uint64_t> big = walk(GraySequence(63), (uint64_t(1) << 63) - 2, 4);
+    assert(big[2] == 0 && big[1] == uint64_t(1) << 62);
+    std::cout << "\033[0;32m✓ Cursors start anywhere and wrap\033[0m" << std::endl;
+
+    // the reflected order flips bit 0 half the time, the balanced one
+    // spreads the flips evenly, exactly at 4, 8 and 16 bits
+    for (int bits : {4, 8, 10, 13, 16}) {
+        GraySequence balanced(bits, GRAY_BALANCED);
+        std::vector<uint64_t> flips(static_cast<size_t>(bits), 0);
+        for (uint64_t i = 0; i < balanced.size(); ++i) ++flips[static_cast<size_t>(balanced.flipped(i))];
+        uint64_t low = *std::min_element(flips.begin(), flips.end()), high = *std::max_element(flips.begin(), flips.end());
+        std::cout << bits << " bits balanced: each bit flips " << low << " to " << high << " times" << std::endl;
+        assert(high - low <= 2 && (bits == 10 || bits == 13 || high == low));
+    }
+    std::cout << "\033[0;32m✓ Balanced flip counts within 2 of each other\033[0m" << std::endl;
+
+    // monotone: the weight never falls more than one below what was seen
+    for (int bits = 1; bits <= 14; ++bits) {
+        GraySequence monotone(bits, GRAY_MONOTONE);
+        int highest = 0;
+        for (uint64_t i = 0; i < monotone.size(); ++i) {
+            int weight = __builtin_popcountll(monotone.code(i));
+            assert(weight + 1 >= highest);
+            highest = std::max(highest, weight);
+        }
+        assert(monotone.cyclic() == (bits == 1));
+    }
+    bool threw = false;
+    try {
+        walk(GraySequence(4, GRAY_MONOTONE), 15, 2);
+    } catch (const std::invalid_argument &) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "\033[0;32m✓ Monotone order climbs through the weights\033[0m" << std::endl;
+
+    // ex08 keeps its binary order
+    std::vector<std::vector<int>> sets = powerset({1, 2, 3});
+    assert((sets == std::vector<std::vector<int>>{{}, {1}, {2}, {1, 2}, {3}, {1, 3}, {2, 3}, {1, 2, 3}}));
+    std::vector<int> eight(8);
+    for (int i = 0; i < 8; ++i) eight[static_cast<size_t>(i)] = 10 * i;
+    std::vector<std::vector<int>> all = powerset(eight);
+    for (size_t i = 0; i < all.size(); ++i) {
+        std::vector<int> expected;
+        for (int j = 0; j < 8; ++j) if ((i >> j) & 1) expected.push_back(10 * j);
+        assert(all[i] == expected);
+    }
+    assert(powerset({}).size() == 1);
+    std::cout << "\033[0;32m✓ powerset enumerates by Gray steps in the same order\033[0m" << std::endl;
+}
+
+int main() {
+    test_gray_walk();
+    test_cone_cost();
+    test_encode_decode();
+    test_sequences();
+    return 0;
+}
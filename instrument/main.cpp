@@ -0,0 +1,114 @@
+// normalization instrumentation main (built with -DBOOLEAN_ALGEBRA_INSTRUMENT)
+
+#include <cassert>
+#include <thread>
+#include "../boolean_algebra.hpp"
+
+void test_stage_counts() {
+    std::cout << "\033[0;33mStage Counter Tests-----------------------\033[0m" << std::endl;
+    static_assert(normalization_instrumented, "build with -DBOOLEAN_ALGEBRA_INSTRUMENT");
+
+    reset_normalization_stats();
+    std::string nnf = negation_normal_form("AB=");
+    const NormalizationCounters &last = normalization_stats().last;
+
+    // A = B -> (A & B) | (!A & !B): two clones, no distribution
+    std::cout << "AB= -> " << nnf << ": parse " << last.parse_nodes << ", eliminate " << last.eliminate_nodes
+              << ", nnf " << last.nnf_nodes << ", clones " << last.clone_calls
+              << ", peak " << last.peak_nodes << std::endl;
+    assert(last.parse_nodes == 3);
+    assert(last.eliminate_nodes == 9);
+    assert(last.nnf_nodes == 9);
+    assert(last.cnf_nodes == 0);
+    assert(last.clone_calls == 2);
+    assert(last.distribution_steps == 0);
+    assert(last.peak_nodes >= 9);
+    std::cout << "\033[0;32m✓ NNF stages counted\033[0m" << std::endl;
+
+    std::string cnf = conjunctive_normal_form("AB&CD&|");
+    std::cout << "AB&CD&| -> " << cnf << ": nnf " << last.nnf_nodes << ", cnf " << last.cnf_nodes
+              << ", distribution steps " << last.distribution_steps << std::endl;
+    assert(last.nnf_nodes == 7);
+    assert(last.cnf_nodes == 13);       // four two-literal clauses under one AND
+    assert(last.distribution_steps == 1);
+    assert(last.peak_nodes >= last.cnf_nodes);
+    std::cout << "\033[0;32m✓ CNF distribution counted\033[0m" << std::endl;
+
+    // (A & A) | !(B ^ B): idempotence, then a constant that decides the OR
+    std::string folded = conjunctive_normal_form("AA&BB^!|");
+    std::cout << "AA&BB^!| -> " << folded << ": parse " << last.parse_nodes << ", simplifications "
+              << last.simplifications << std::endl;
+    assert(folded == "1");
+    assert(last.parse_nodes == 1);
+    assert(last.simplifications == 4);
+    assert(last.distribution_steps == 0);
+    std::cout << "\033[0;32m✓ Simplifications counted\033[0m" << std::endl;
+}
+
+void test_totals() {
+    std::cout << "\n\033[0;33mCumulative Counter Tests------------------\033[0m" << std::endl;
+
+    reset_normalization_stats();
+    for (int i = 0; i < 10; ++i) negation_normal_form("AB&!");
+    const NormalizationStats &stats = normalization_stats();
+
+    assert(stats.calls == 10);
+    assert(stats.total.parse_nodes == 10 * stats.last.parse_nodes);
+    assert(stats.total.peak_nodes == stats.last.peak_nodes);
+    assert(stats.total.parse_seconds >= stats.last.parse_seconds);
+
+    // failed calls still count, with the stages they reached
+    try {
+        conjunctive_normal_form("A&");
+        assert(false);
+    } catch (const std::invalid_argument &) {
+    }
+    assert(stats.calls == 11);
+    std::cout << "\033[0;32m✓ Calls accumulate, failures included\033[0m" << std::endl;
+
+    // an AST kept alive by the caller does not inflate the next call's peak
+    auto held = parse_rpn_to_ast("AB&CD&|EF&|");
+    negation_normal_form("AB&");
+    assert(stats.last.peak_nodes == 3);
+    std::cout << "\033[0;32m✓ Peak counts only the call's own nodes\033[0m" << std::endl;
+}
+
+void test_thread_local() {
+    std::cout << "\n\033[0;33mThread-Local Tests------------------------\033[0m" << std::endl;
+
+    reset_normalization_stats();
+    uint64_t worker_calls = 0;
+    std::thread worker([&] {
+        for (int i = 0; i < 5; ++i) conjunctive_normal_form("AB|C&");
+        worker_calls = normalization_stats().calls;
+    });
+    worker.join();
+
+    assert(worker_calls == 5);
+    assert(normalization_stats().calls == 0);
+    std::cout << "\033[0;32m✓ Each thread keeps its own counters\033[0m" << std::endl;
+}
+
+void test_prometheus() {
+    std::cout << "\n\033[0;33mPrometheus Dump Tests---------------------\033[0m" << std::endl;
+
+    reset_normalization_stats();
+    conjunctive_normal_form("AB^C|");
+    std::string text = normalization_stats_prometheus();
+    std::cout << text;
+
+    assert(text.find("# TYPE boolean_algebra_normalization_calls_total counter") != std::string::npos);
+    assert(text.find("boolean_algebra_normalization_calls_total 1\n") != std::string::npos);
+    assert(text.find("boolean_algebra_normalization_nodes_total{stage=\"cnf\"} ") != std::string::npos);
+    assert(text.find("boolean_algebra_normalization_seconds_total{stage=\"emit\"} ") != std::string::npos);
+    assert(text.find("boolean_algebra_normalization_peak_nodes ") != std::string::npos);
+    std::cout << "\033[0;32m✓ Text exposition format\033[0m" << std::endl;
+}
+
+int main() {
+    test_stage_counts();
+    test_totals();
+    test_thread_local();
+    test_prometheus();
+    return 0;
+}
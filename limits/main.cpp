@@ -0,0 +1,180 @@
+// resource limits main
+
+#include <cassert>
+#include <thread>
+#include "../boolean_algebra.hpp"
+
+// (A & B) | (C & D) | ... : CNF with 2^pairs clauses
+std::string dnf_pairs(int pairs) {
+    std::string f;
+    for (int i = 0; i < pairs; ++i) {
+        f += static_cast<char>('A' + 2 * i);
+        f += static_cast<char>('A' + 2 * i + 1);
+        f += '&';
+        if (i > 0) f += '|';
+    }
+    return f;
+}
+
+// A & B & ... & !A over n variables: sat visits all 2^n assignments
+std::string unsat_chain(int n) {
+    std::string f = "A";
+    for (int i = 1; i < n; ++i) {
+        f += static_cast<char>('A' + i);
+        f += '&';
+    }
+    return f + "A!&";
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void test_unlimited() {
+    std::cout << "\033[0;33mUnlimited Calls Tests---------------------\033[0m" << std::endl;
+
+    ResourceLimits none;
+    Limited<std::string> nnf = negation_normal_form("AB&!", none);
+    Limited<std::string> cnf = conjunctive_normal_form("AB&C|", none);
+    Limited<bool> s = sat("AA!&", none);
+
+    assert(nnf.ok() && nnf.value == negation_normal_form("AB&!"));
+    assert(cnf.ok() && cnf.value == conjunctive_normal_form("AB&C|"));
+    assert(s.ok() && s.value == false);
+    std::cout << "\033[0;32m✓ Default limits give the plain results\033[0m" << std::endl;
+
+    // malformed input is still an error, not a limit
+    bool threw = false;
+    try {
+        conjunctive_normal_form("A&", none);
+    } catch (const std::invalid_argument &) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "\033[0;32m✓ Invalid formulas still throw\033[0m" << std::endl;
+}
+
+void test_node_and_memory_budgets() {
+    std::cout << "\n\033[0;33mNode and Memory Budget Tests--------------\033[0m" << std::endl;
+
+    std::string f = dnf_pairs(10);     // 1024 clauses, ~30k nodes
+    uint64_t live_before = ast_live_nodes;
+
+    ResourceLimits nodes;
+    nodes.max_nodes = 2000;
+    Limited<std::string> r = conjunctive_normal_form(f, nodes);
+    std::cout << "CNF of 10 pairs, 2000 nodes: " << limit_status_name(r.status) << std::endl;
+    assert(r.status == LIMIT_NODES && r.value.empty());
+    assert(ast_live_nodes == live_before);
+
+    nodes.max_nodes = 100000;
+    assert(conjunctive_normal_form(f, nodes).ok());
+    std::cout << "\033[0;32m✓ Node budget stops the distribution\033[0m" << std::endl;
+
+    ResourceLimits memory;
+    memory.max_memory_bytes = 64 * 1024;
+    r = conjunctive_normal_form(f, memory);
+    std::cout << "CNF of 10 pairs, 64 KiB: " << limit_status_name(r.status) << std::endl;
+    assert(r.status == LIMIT_MEMORY);
+    assert(ast_live_nodes == live_before);
+
+    // a budget that holds the whole conversion lets it finish
+    memory.max_memory_bytes = 1 << 20;
+    assert(conjunctive_normal_form(dnf_pairs(4), memory).ok());
+    std::cout << "\033[0;32m✓ Memory budget stops the distribution\033[0m" << std::endl;
+
+    // A & B & ... & Z is one AND node over 26 operands, which no longer fit
+    // inside the node: its operand array counts too
+    std::string wide = "ABCDEFGHIJKLMNOPQRSTUVWXYZ" + std::string(25, '&');
+    uint64_t operand_bytes_before = ast_operand_bytes;
+    memory.max_memory_bytes = 27 * sizeof(NNFNode) + 64;
+    r = negation_normal_form(wide, memory);
+    std::cout << "NNF of a 26-operand AND, nodes and output only: " << limit_status_name(r.status) << std::endl;
+    assert(r.status == LIMIT_MEMORY);
+    assert(ast_live_nodes == live_before && ast_operand_bytes == operand_bytes_before);
+
+    memory.max_memory_bytes += 64 * sizeof(std::unique_ptr<NNFNode>);
+    r = negation_normal_form(wide, memory);
+    assert(r.ok() && r.value == wide);
+    assert(ast_operand_bytes == operand_bytes_before);
+    std::cout << "\033[0;32m✓ Operand arrays count against the memory budget\033[0m" << std::endl;
+}
+
+void test_deadline() {
+    std::cout << "\n\033[0;33mDeadline Tests----------------------------\033[0m" << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    Limited<bool> s = sat(unsat_chain(24), ResourceLimits::timeout(std::chrono::milliseconds(20)));
+    double ms = elapsed_ms(start);
+    std::cout << "sat over 24 variables, 20 ms deadline: " << limit_status_name(s.status)
+              << " after " << ms << " ms" << std::endl;
+    assert(s.status == LIMIT_DEADLINE);
+    assert(ms < 1000);
+
+    // a deadline in the past stops the call before any work
+    ResourceLimits past;
+    past.deadline = std::chrono::steady_clock::now() - std::chrono::seconds(1);
+    assert(negation_normal_form("AB&", past).status == LIMIT_DEADLINE);
+    std::cout << "\033[0;32m✓ Deadlines are honoured\033[0m" << std::endl;
+}
+
+void test_cancellation() {
+    std::cout << "\n\033[0;33mCancellation Tests------------------------\033[0m" << std::endl;
+
+    CancellationToken token;
+    ResourceLimits limits;
+    limits.cancel = &token;
+
+    std::thread canceller([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        token.cancel();
+    });
+    auto start = std::chrono::steady_clock::now();
+    Limited<bool> s = sat(unsat_chain(24), limits);
+    double ms = elapsed_ms(start);
+    canceller.join();
+    std::cout << "sat cancelled from another thread after " << ms << " ms" << std::endl;
+    assert(s.status == LIMIT_CANCELLED);
+
+    // already cancelled: the truth table prints nothing
+    std::ostringstream sink;
+    std::streambuf *saved = std::cout.rdbuf(sink.rdbuf());
+    LimitStatus status = print_truth_table("AB&", limits);
+    std::cout.rdbuf(saved);
+    assert(status == LIMIT_CANCELLED && sink.str().empty());
+
+    token.reset();
+    saved = std::cout.rdbuf(sink.rdbuf());
+    status = print_truth_table("AB&", limits);
+    std::cout.rdbuf(saved);
+    assert(status == LIMIT_OK && !sink.str().empty());
+    std::cout << "\033[0;32m✓ Cancellation tokens stop sat and truth tables\033[0m" << std::endl;
+}
+
+void test_scopes() {
+    std::cout << "\n\033[0;33mScope Tests-------------------------------\033[0m" << std::endl;
+
+    ResourceLimits nodes;
+    nodes.max_nodes = 10;
+    conjunctive_normal_form(dnf_pairs(6), nodes);
+    assert(active_limits == nullptr);
+
+    // limits are per thread: a limited call elsewhere does not affect this one
+    std::thread other([] {
+        ResourceLimits tiny;
+        tiny.max_nodes = 1;
+        assert(negation_normal_form("AB&", tiny).status == LIMIT_NODES);
+    });
+    other.join();
+    assert(conjunctive_normal_form(dnf_pairs(6)).size() > 0);
+    std::cout << "\033[0;32m✓ Limits apply to one call on one thread\033[0m" << std::endl;
+}
+
+int main() {
+    test_unlimited();
+    test_node_and_memory_budgets();
+    test_deadline();
+    test_cancellation();
+    test_scopes();
+    return 0;
+}
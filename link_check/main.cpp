@@ -0,0 +1,31 @@
+// link check main: the library headers are included from two translation
+// units (main.cpp and other.cpp) linked into one program, as in a service
+
+#include <cassert>
+#include "../boolean_algebra.hpp"
+#include "../formula_cache.hpp"
+#include "../formula_jit.hpp"
+#include "../clause_set.hpp"
+#include "../dimacs.hpp"
+#include "../sat_solver.hpp"
+#include "../sat_portfolio.hpp"
+#include "../minimize.hpp"
+#include "../formula_cse.hpp"
+#include "../wide_uint.hpp"
+#include "../formula_generator.hpp"
+
+std::string other_nnf(const std::string &rpn);
+bool other_sat(const std::string &formula);
+int other_adder(int a, int b);
+
+int main() {
+    std::cout << "\033[0;33mMultiple Translation Units Tests----------------------\033[0m" << std::endl;
+
+    assert(negation_normal_form("AB&!") == other_nnf("AB&!"));
+    assert(sat("AA!&") == other_sat("AA!&"));
+    assert(adder(3, 5) == other_adder(3, 5));
+    assert(JitFormula("AB&").eval(0b11));
+
+    std::cout << "\033[0;32m✓ Headers link from several translation units\033[0m" << std::endl;
+    return 0;
+}
@@ -0,0 +1,26 @@
+// second translation unit for the link check
+
+#include "../boolean_algebra.hpp"
+#include "../formula_cache.hpp"
+#include "../formula_jit.hpp"
+#include "../clause_set.hpp"
+#include "../dimacs.hpp"
+#include "../sat_solver.hpp"
+#include "../sat_portfolio.hpp"
+#include "../minimize.hpp"
+#include "../formula_cse.hpp"
+#include "../wide_uint.hpp"
+#include "../formula_generator.hpp"
+
+std::string other_nnf(const std::string &rpn) {
+    FormulaCache cache(16);
+    return cache.negation_normal_form(rpn);
+}
+
+bool other_sat(const std::string &formula) {
+    return sat(formula);
+}
+
+int other_adder(int a, int b) {
+    return multiplier(adder(a, b), 1);
+}
@@ -0,0 +1,520 @@
+#ifndef MINIMIZE_HPP
+#define MINIMIZE_HPP
+
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include "formula_jit.hpp"
+
+// Two-level minimization: a formula to a minimal or near-minimal sum of
+// products (or product of sums).
+//
+// The formula's truth table is computed 64 rows at a time with JitFormula.
+// Minterm m sets bit j for the j-th variable used, alphabetically, and a
+// table of fewer than six variables fills its one word by repetition.
+// Implicants are bitmasks: `care` marks the variables present, and `value`
+// their polarity.
+//
+// Up to kExactVariables variables, Quine-McCluskey merges implicants into
+// all the primes, and a branch and bound picks the fewest primes covering
+// the function (then the fewest literals), settling for the best cover
+// found if it runs out of nodes. Above that, an irredundant sum of products
+// (Minato-Morreale) is improved Espresso-style: reduce each cube to what
+// only it covers, expand it to a prime, drop redundant cubes, until the
+// cost stops falling. A product of sums is the complement's sum of
+// products, negated.
+
+enum MinimizeForm {
+    MINIMIZE_SOP,       // (A & B) | (!C & D)
+    MINIMIZE_POS        // (A | B) & (!C | D)
+};
+
+struct Implicant {
+    uint32_t care;
+    uint32_t value;
+
+    int literal_count() const { return count_variables(care); }
+    bool covers(uint32_t minterm) const { return (minterm & care) == value; }
+    bool operator==(const Implicant &o) const { return care == o.care && value == o.value; }
+};
+
+constexpr int kExactVariables = 10;
+constexpr int kMaxMinimizeVariables = 20;
+
+// bit m of kMintermPatterns[j] is bit j of m
+constexpr uint64_t kMintermPatterns[6] = {
+    0xAAAAAAAAAAAAAAAAull, 0xCCCCCCCCCCCCCCCCull, 0xF0F0F0F0F0F0F0F0ull,
+    0xFF00FF00FF00FF00ull, 0xFFFF0000FFFF0000ull, 0xFFFFFFFF00000000ull
+};
+
+inline size_t minterm_words(int n) { return n <= 6 ? 1 : size_t(1) << (n - 6); }
+
+// Truth table over the formula's variables, in minterm order
+inline std::vector<uint64_t> minterm_table(const std::string &rpn, int &variables) {
+    JitFormula formula(rpn);
+    uint32_t used = formula.variables();
+    int n = count_variables(used);
+    if (n > kMaxMinimizeVariables) {
+        throw std::invalid_argument("Error: minimize supports at most " + std::to_string(kMaxMinimizeVariables) + " variables");
+    }
+    variables = n;
+
+    int letters[26];
+    for (int v = 0, j = 0; v < 26; ++v) {
+        if ((used >> v) & 1) letters[j++] = v;
+    }
+
+    std::vector<uint64_t> table(minterm_words(n));
+    uint64_t columns[26] = {};
+    for (int j = 0; j < n && j < 6; ++j) columns[letters[j]] = kMintermPatterns[j];
+    for (size_t w = 0; w < table.size(); ++w) {
+        limit_poll();
+        for (int j = 6; j < n; ++j) columns[letters[j]] = uint64_t(0) - ((w >> (j - 6)) & 1);
+        table[w] = formula.eval_sliced(columns);
+    }
+    return table;
+}
+
+// Visits every word of the table the implicant touches, with the mask of its
+// minterms within that word
+template <typename F>
+void for_each_implicant_word(const Implicant &c, int n, F &&f) {
+    uint64_t mask = ~uint64_t(0);
+    for (int j = 0; j < n && j < 6; ++j) {
+        if ((c.care >> j) & 1) mask &= ((c.value >> j) & 1) ? kMintermPatterns[j] : ~kMintermPatterns[j];
+    }
+    if (n <= 6) {
+        f(size_t(0), mask);
+        return;
+    }
+    size_t high = (size_t(1) << (n - 6)) - 1;
+    size_t fixed = (c.value >> 6) & high;
+    size_t free = ~(c.care >> 6) & high;
+    size_t s = 0;
+    do {
+        f(fixed | s, mask);
+        s = (s - free) & free;
+    } while (s != 0);
+}
+
+inline bool implicant_within(const Implicant &c, const std::vector<uint64_t> &table, int n) {
+    bool inside = true;
+    for_each_implicant_word(c, n, [&](size_t w, uint64_t mask) {
+        inside = inside && (table[w] & mask) == mask;
+    });
+    return inside;
+}
+
+// All prime implicants by Quine-McCluskey: implicants differing in one
+// variable's polarity merge into one without it, level by level; those that
+// never merge are prime
+inline std::vector<Implicant> prime_implicants(const std::vector<uint64_t> &table, int n) {
+    auto key = [](uint32_t care, uint32_t value) { return (uint64_t(care) << 32) | value; };
+    uint32_t all = (1u << n) - 1;
+
+    std::vector<Implicant> current;
+    for (uint32_t m = 0; m < (uint32_t(1) << n); ++m) {
+        if ((table[m >> 6] >> (m & 63)) & 1) current.push_back({all, m});
+    }
+
+    std::vector<Implicant> primes;
+    while (!current.empty()) {
+        std::unordered_map<uint64_t, size_t> index;
+        for (size_t i = 0; i < current.size(); ++i) index[key(current[i].care, current[i].value)] = i;
+
+        std::vector<char> merged(current.size(), 0);
+        std::unordered_set<uint64_t> next_keys;
+        std::vector<Implicant> next;
+        for (size_t i = 0; i < current.size(); ++i) {
+            limit_poll();
+            const Implicant &c = current[i];
+            for (uint32_t bits = c.care & ~c.value; bits; bits &= bits - 1) {
+                uint32_t b = bits & (0u - bits);
+                auto partner = index.find(key(c.care, c.value | b));
+                if (partner == index.end()) continue;
+                merged[i] = merged[partner->second] = 1;
+                if (next_keys.insert(key(c.care & ~b, c.value)).second) next.push_back({c.care & ~b, c.value});
+            }
+        }
+        for (size_t i = 0; i < current.size(); ++i) {
+            if (!merged[i]) primes.push_back(current[i]);
+        }
+        current.swap(next);
+    }
+    return primes;
+}
+
+// Fewest primes covering every minterm, then fewest literals. Essential
+// primes are taken first; the rest is a branch and bound that always
+// branches on the minterm with the fewest candidates, within a node budget.
+inline std::vector<Implicant> select_cover(const std::vector<Implicant> &primes, const std::vector<uint64_t> &table, int n) {
+    std::vector<uint32_t> minterms;
+    for (uint32_t m = 0; m < (uint32_t(1) << n); ++m) {
+        if ((table[m >> 6] >> (m & 63)) & 1) minterms.push_back(m);
+    }
+    size_t words = (minterms.size() + 63) / 64;
+
+    // coverage[p]: the minterms (by index) prime p covers; covering[i]: the primes covering minterm i
+    std::vector<std::vector<uint64_t>> coverage(primes.size(), std::vector<uint64_t>(words, 0));
+    std::vector<std::vector<uint32_t>> covering(minterms.size());
+    for (size_t p = 0; p < primes.size(); ++p) {
+        for (size_t i = 0; i < minterms.size(); ++i) {
+            if (primes[p].covers(minterms[i])) {
+                coverage[p][i / 64] |= uint64_t(1) << (i % 64);
+                covering[i].push_back(static_cast<uint32_t>(p));
+            }
+        }
+    }
+
+    std::vector<uint64_t> uncovered(words, 0);
+    for (size_t i = 0; i < minterms.size(); ++i) uncovered[i / 64] |= uint64_t(1) << (i % 64);
+    auto take = [&](std::vector<uint64_t> &u, size_t p) {
+        for (size_t w = 0; w < words; ++w) u[w] &= ~coverage[p][w];
+    };
+    auto is_uncovered = [](const std::vector<uint64_t> &u, size_t i) { return (u[i / 64] >> (i % 64)) & 1; };
+
+    std::vector<uint32_t> chosen;
+    for (size_t i = 0; i < minterms.size(); ++i) {
+        if (covering[i].size() == 1 && is_uncovered(uncovered, i)) {
+            chosen.push_back(covering[i][0]);
+            take(uncovered, covering[i][0]);
+        }
+    }
+
+    auto cost = [&](const std::vector<uint32_t> &set) {
+        size_t literals = 0;
+        for (uint32_t p : set) literals += primes[p].literal_count();
+        return std::make_pair(set.size(), literals);
+    };
+
+    // greedy: most new minterms per prime, fewer literals on ties
+    std::vector<uint32_t> best = chosen;
+    std::vector<uint64_t> rest = uncovered;
+    for (;;) {
+        size_t best_p = primes.size(), best_gain = 0;
+        for (size_t p = 0; p < primes.size(); ++p) {
+            size_t gain = 0;
+            for (size_t w = 0; w < words; ++w) gain += __builtin_popcountll(coverage[p][w] & rest[w]);
+            if (gain > best_gain || (gain == best_gain && gain > 0 && primes[p].literal_count() < primes[best_p].literal_count())) {
+                best_p = p;
+                best_gain = gain;
+            }
+        }
+        if (best_gain == 0) break;
+        best.push_back(static_cast<uint32_t>(best_p));
+        take(rest, best_p);
+    }
+    auto best_cost = cost(best);
+
+    // Lower bound on the primes still needed: uncovered minterms no two of
+    // which share a prime each need their own
+    std::vector<uint32_t> mark(primes.size(), 0);
+    uint32_t stamp = 0;
+    auto lower_bound = [&](const std::vector<uint64_t> &u) {
+        ++stamp;
+        size_t bound = 0;
+        for (size_t i = 0; i < minterms.size(); ++i) {
+            if (!is_uncovered(u, i)) continue;
+            bool independent = true;
+            for (uint32_t p : covering[i]) independent = independent && mark[p] != stamp;
+            if (!independent) continue;
+            ++bound;
+            for (uint32_t p : covering[i]) mark[p] = stamp;
+        }
+        return bound;
+    };
+
+    size_t budget = 20000;
+    std::vector<uint32_t> path = chosen;
+    std::function<void(const std::vector<uint64_t> &)> search = [&](const std::vector<uint64_t> &u) {
+        if (budget == 0) return;
+        --budget;
+        limit_poll();
+
+        size_t pick = minterms.size(), fewest = SIZE_MAX;
+        for (size_t i = 0; i < minterms.size(); ++i) {
+            if (is_uncovered(u, i) && covering[i].size() < fewest) {
+                pick = i;
+                fewest = covering[i].size();
+            }
+        }
+        auto now = cost(path);
+        if (pick == minterms.size()) {
+            if (now < best_cost) {
+                best = path;
+                best_cost = now;
+            }
+            return;
+        }
+        if (now.first + lower_bound(u) > best_cost.first) return;
+
+        for (uint32_t p : covering[pick]) {
+            path.push_back(p);
+            std::vector<uint64_t> next = u;
+            take(next, p);
+            search(next);
+            path.pop_back();
+        }
+    };
+    search(uncovered);
+
+    std::vector<Implicant> cover;
+    for (uint32_t p : best) cover.push_back(primes[p]);
+    return cover;
+}
+
+// Minato-Morreale irredundant sum of products for the interval [lower,
+// upper] over variables 0..k-1; cubes get the literals of the path down to
+// them. Returns the function the cubes produced.
+inline std::vector<uint64_t> isop(const std::vector<uint64_t> &lower, const std::vector<uint64_t> &upper, int k,
+                                  Implicant path, std::vector<Implicant> &out) {
+    limit_poll();
+    size_t words = lower.size();
+    bool lower_zero = std::all_of(lower.begin(), lower.end(), [](uint64_t w) { return w == 0; });
+    if (lower_zero) return std::vector<uint64_t>(words, 0);
+    bool upper_one = std::all_of(upper.begin(), upper.end(), [](uint64_t w) { return w == ~uint64_t(0); });
+    if (upper_one) {
+        out.push_back(path);
+        return std::vector<uint64_t>(words, ~uint64_t(0));
+    }
+
+    int x = k - 1;
+    std::vector<uint64_t> l0, l1, u0, u1;
+    auto cofactor = [&](const std::vector<uint64_t> &t, std::vector<uint64_t> &c0, std::vector<uint64_t> &c1) {
+        if (x >= 6) {
+            c0.assign(t.begin(), t.begin() + words / 2);
+            c1.assign(t.begin() + words / 2, t.end());
+        } else {
+            uint64_t s = uint64_t(1) << x;
+            uint64_t w0 = t[0] & ~kMintermPatterns[x], w1 = t[0] & kMintermPatterns[x];
+            c0.assign(1, w0 | (w0 << s));
+            c1.assign(1, w1 | (w1 >> s));
+        }
+    };
+    auto join = [&](const std::vector<uint64_t> &c0, const std::vector<uint64_t> &c1) {
+        if (x >= 6) {
+            std::vector<uint64_t> t(c0);
+            t.insert(t.end(), c1.begin(), c1.end());
+            return t;
+        }
+        return std::vector<uint64_t>(1, (c0[0] & ~kMintermPatterns[x]) | (c1[0] & kMintermPatterns[x]));
+    };
+    cofactor(lower, l0, l1);
+    cofactor(upper, u0, u1);
+
+    if (l0 == l1 && u0 == u1) {
+        std::vector<uint64_t> r = isop(l0, u0, k - 1, path, out);
+        return join(r, r);
+    }
+
+    size_t half = l0.size();
+    std::vector<uint64_t> a(half), b(half);
+    for (size_t w = 0; w < half; ++w) a[w] = l0[w] & ~u1[w];
+    std::vector<uint64_t> r0 = isop(a, u0, k - 1, {path.care | (1u << x), path.value}, out);
+    for (size_t w = 0; w < half; ++w) a[w] = l1[w] & ~u0[w];
+    std::vector<uint64_t> r1 = isop(a, u1, k - 1, {path.care | (1u << x), path.value | (1u << x)}, out);
+    for (size_t w = 0; w < half; ++w) {
+        a[w] = (l0[w] & ~r0[w]) | (l1[w] & ~r1[w]);
+        b[w] = u0[w] & u1[w];
+    }
+    std::vector<uint64_t> rs = isop(a, b, k - 1, path, out);
+    for (size_t w = 0; w < half; ++w) {
+        r0[w] |= rs[w];
+        r1[w] |= rs[w];
+    }
+    return join(r0, r1);
+}
+
+// Espresso-style improvement of a cover of `table`
+class CoverRefiner {
+public:
+    CoverRefiner(const std::vector<uint64_t> &table, int n)
+        : table_(table), n_(n), counts_(table.size() * 64, 0) {}
+
+    std::vector<Implicant> refine(std::vector<Implicant> cover) {
+        expand(cover);
+        irredundant(cover);
+        for (int round = 0; round < 8; ++round) {
+            std::vector<Implicant> next = cover;
+            reduce(next);
+            expand(next);
+            irredundant(next);
+            if (!(cost(next) < cost(cover))) break;
+            cover.swap(next);
+        }
+        return cover;
+    }
+
+private:
+    const std::vector<uint64_t> &table_;
+    int n_;
+    std::vector<uint16_t> counts_;      // cubes covering each minterm
+
+    static std::pair<size_t, size_t> cost(const std::vector<Implicant> &cover) {
+        size_t literals = 0;
+        for (const Implicant &c : cover) literals += c.literal_count();
+        return {cover.size(), literals};
+    }
+
+    template <typename F>
+    void for_each_minterm(const Implicant &c, F &&f) {
+        for_each_implicant_word(c, n_, [&](size_t w, uint64_t mask) {
+            for (; mask; mask &= mask - 1) f(w * 64 + __builtin_ctzll(mask));
+        });
+    }
+
+    void count(const std::vector<Implicant> &cover) {
+        std::fill(counts_.begin(), counts_.end(), 0);
+        for (const Implicant &c : cover) for_each_minterm(c, [&](size_t m) { ++counts_[m]; });
+    }
+
+    // each cube to a prime: drop literals while it stays inside the
+    // function, then drop cubes another one now contains
+    void expand(std::vector<Implicant> &cover) {
+        std::sort(cover.begin(), cover.end(), [](const Implicant &a, const Implicant &b) {
+            return a.literal_count() < b.literal_count();
+        });
+        for (Implicant &c : cover) {
+            limit_poll();
+            for (uint32_t bits = c.care; bits; bits &= bits - 1) {
+                uint32_t b = bits & (0u - bits);
+                Implicant wider{c.care & ~b, c.value & ~b};
+                if (implicant_within(wider, table_, n_)) c = wider;
+            }
+        }
+        std::vector<Implicant> kept;
+        for (size_t i = 0; i < cover.size(); ++i) {
+            bool contained = false;
+            for (size_t j = 0; j < cover.size() && !contained; ++j) {
+                if (i == j) continue;
+                const Implicant &a = cover[i], &b = cover[j];
+                bool inside = (a.care & b.care) == b.care && (a.value & b.care) == b.value;
+                contained = inside && (!(a == b) || j < i);
+            }
+            if (!contained) kept.push_back(cover[i]);
+        }
+        cover.swap(kept);
+    }
+
+    // drop cubes whose minterms all have another cube, smallest first
+    void irredundant(std::vector<Implicant> &cover) {
+        count(cover);
+        std::vector<size_t> order(cover.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return cover[a].literal_count() > cover[b].literal_count();
+        });
+
+        std::vector<char> removed(cover.size(), 0);
+        for (size_t i : order) {
+            limit_poll();
+            bool redundant = true;
+            for_each_minterm(cover[i], [&](size_t m) { redundant = redundant && counts_[m] >= 2; });
+            if (!redundant) continue;
+            removed[i] = 1;
+            for_each_minterm(cover[i], [&](size_t m) { --counts_[m]; });
+        }
+        std::vector<Implicant> kept;
+        for (size_t i = 0; i < cover.size(); ++i) {
+            if (!removed[i]) kept.push_back(cover[i]);
+        }
+        cover.swap(kept);
+    }
+
+    // each cube to the smallest one holding the minterms only it covers,
+    // largest cubes first
+    void reduce(std::vector<Implicant> &cover) {
+        count(cover);
+        std::sort(cover.begin(), cover.end(), [](const Implicant &a, const Implicant &b) {
+            return a.literal_count() < b.literal_count();
+        });
+        uint32_t all = (1u << n_) - 1;
+
+        std::vector<Implicant> kept;
+        for (Implicant &c : cover) {
+            limit_poll();
+            uint32_t ones = 0, zeros = 0;
+            bool any = false;
+            for_each_minterm(c, [&](size_t m) {
+                if (counts_[m] != 1) return;
+                any = true;
+                ones |= static_cast<uint32_t>(m);
+                zeros |= ~static_cast<uint32_t>(m);
+            });
+            for_each_minterm(c, [&](size_t m) { --counts_[m]; });
+            if (!any) continue;
+
+            // variables fixed across those minterms
+            Implicant reduced{~(ones & zeros) & all, ones & ~zeros & all};
+            for_each_minterm(reduced, [&](size_t m) { ++counts_[m]; });
+            kept.push_back(reduced);
+        }
+        cover.swap(kept);
+    }
+};
+
+inline std::vector<Implicant> minimize_cover(const std::vector<uint64_t> &table, int n) {
+    if (n <= kExactVariables) return select_cover(prime_implicants(table, n), table, n);
+
+    std::vector<Implicant> cover;
+    isop(table, table, n, {0, 0}, cover);
+    return CoverRefiner(table, n).refine(std::move(cover));
+}
+
+// A cover as RPN over the given letters: products joined by '|' for a sum of
+// products; for a product of sums each implicant is a clause of negated
+// literals, joined by '&'. Operators follow their operands, as in
+// ClauseSet::to_rpn.
+inline std::string cover_to_rpn(const std::vector<Implicant> &cover, const int *letters, int n, MinimizeForm form) {
+    bool sop = form == MINIMIZE_SOP;
+    if (cover.empty()) return sop ? "0" : "1";
+
+    std::string out;
+    for (const Implicant &c : cover) {
+        if (c.care == 0) return sop ? "1" : "0";
+        bool first = true;
+        for (int j = 0; j < n; ++j) {
+            if (!((c.care >> j) & 1)) continue;
+            out += static_cast<char>('A' + letters[j]);
+            if (((c.value >> j) & 1) != sop) out += '!';
+            if (!first) out += sop ? '&' : '|';
+            first = false;
+        }
+    }
+    out.append(cover.size() - 1, sop ? '|' : '&');
+    return out;
+}
+
+// Implicants in the order their literals read, first variable first,
+// positive before negated
+inline bool implicant_reads_before(const Implicant &a, const Implicant &b) {
+    for (uint32_t j = 0; j < 32; ++j) {
+        bool ca = (a.care >> j) & 1, cb = (b.care >> j) & 1;
+        if (ca != cb) return ca;
+        if (ca && ((a.value ^ b.value) >> j & 1)) return (a.value >> j) & 1;
+    }
+    return false;
+}
+
+inline std::string minimize(const std::string &rpn, MinimizeForm form = MINIMIZE_SOP) {
+    int n = 0;
+    std::vector<uint64_t> table = minterm_table(rpn, n);
+    if (form == MINIMIZE_POS) {
+        for (uint64_t &w : table) w = ~w;
+    }
+
+    uint32_t used = formula_variables(rpn);
+    int letters[26];
+    for (int v = 0, j = 0; v < 26; ++v) {
+        if ((used >> v) & 1) letters[j++] = v;
+    }
+    std::vector<Implicant> cover = minimize_cover(table, n);
+    std::sort(cover.begin(), cover.end(), implicant_reads_before);
+    return cover_to_rpn(cover, letters, n, form);
+}
+
+inline Limited<std::string> minimize(const std::string &rpn, MinimizeForm form, const ResourceLimits &limits) {
+    return run_with_limits<std::string>(limits, [&] { return minimize(rpn, form); });
+}
+
+#endif
@@ -0,0 +1,191 @@
+// minimization main
+
+#include <cassert>
+#include "../minimize.hpp"
+#include "../formula_generator.hpp"
+
+bool equivalent(const std::string &f, const std::string &g) {
+    uint32_t variables = formula_variables(f) | formula_variables(g);
+    return formula_truth_table_bits(f, variables) == formula_truth_table_bits(g, variables);
+}
+
+size_t operator_count(const std::string &f) {
+    return std::count_if(f.begin(), f.end(), [](char c) { return c == '&' || c == '|' || c == '!'; });
+}
+
+// the truth table a cover describes
+std::vector<uint64_t> cover_table(const std::vector<Implicant> &cover, int n) {
+    std::vector<uint64_t> table(minterm_words(n), 0);
+    for (const Implicant &c : cover) {
+        for_each_implicant_word(c, n, [&](size_t w, uint64_t mask) { table[w] |= mask; });
+    }
+    return table;
+}
+
+void test_small() {
+    std::cout << "\033[0;33mMinimization Tests------------------------\033[0m" << std::endl;
+
+    struct Case { const char *formula; const char *sop; const char *pos; };
+    const Case cases[] = {
+        {"AB&C|", "AB&C|", "AC|BC|&"},
+        {"AB&AC!&|BC&|", "AC!&BC&|", "AC|BC!|&"},
+        {"AB=", "AB&A!B!&|", "A!B|AB!|&"},
+        {"AB>A&", "AB&", "AB&"},
+        {"AA!|", "1", "1"},
+        {"AB&A!&", "0", "0"},
+    };
+    for (const Case &c : cases) {
+        std::string sop = minimize(c.formula);
+        std::string pos = minimize(c.formula, MINIMIZE_POS);
+        std::cout << c.formula << " -> " << sop << "  /  " << pos << std::endl;
+        assert(sop == c.sop && pos == c.pos);
+    }
+    std::cout << "\033[0;32m✓ Minimal sums of products and products of sums\033[0m" << std::endl;
+
+    // the normal forms of ex05/ex06 shrink back
+    for (std::string f : {"AB=", "AB^C|", "AB&CD&|", "AB>C="}) {
+        std::string cnf = conjunctive_normal_form(f);
+        std::string pos = minimize(cnf, MINIMIZE_POS);
+        std::cout << "conjunctive_normal_form(" << f << ") = " << cnf << " -> " << pos << std::endl;
+        assert(equivalent(cnf, pos) && operator_count(pos) <= operator_count(cnf));
+    }
+    std::cout << "\033[0;32m✓ CNF output minimized\033[0m" << std::endl;
+
+    bool threw = false;
+    try {
+        minimize("AB&|");
+    } catch (const std::invalid_argument &) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+void test_quine_mccluskey() {
+    std::cout << "\n\033[0;33mQuine-McCluskey Tests---------------------\033[0m" << std::endl;
+
+    // classic textbook function: f(A,B,C,D) = sum m(4, 8, 10, 11, 12, 15)
+    std::vector<uint64_t> table(1, 0);
+    for (uint32_t m : {4u, 8u, 10u, 11u, 12u, 15u}) {
+        // minterm bit j is variable j; the textbook numbers A as the high bit
+        uint32_t swapped = ((m >> 3) & 1) | ((m >> 1) & 2) | ((m << 1) & 4) | ((m << 3) & 8);
+        for (uint32_t copy = swapped; copy < 64; copy += 16) table[0] |= uint64_t(1) << copy;
+    }
+    std::vector<Implicant> primes = prime_implicants(table, 4);
+    std::vector<Implicant> cover = select_cover(primes, table, 4);
+    std::cout << primes.size() << " primes, cover of " << cover.size() << std::endl;
+    assert(primes.size() == 5 && cover.size() == 3);
+    assert(cover_table(cover, 4) == table);
+    std::cout << "\033[0;32m✓ Primes and cover\033[0m" << std::endl;
+
+    // random functions: every prime is inside the function and maximal
+    GeneratorOptions options;
+    options.variables = 7;
+    options.depth = 5;
+    FormulaGenerator gen(3, options);
+    for (int i = 0; i < 50; ++i) {
+        int n;
+        std::vector<uint64_t> t = minterm_table(gen.next(), n);
+        for (const Implicant &p : prime_implicants(t, n)) {
+            assert(implicant_within(p, t, n));
+            for (uint32_t bits = p.care; bits; bits &= bits - 1) {
+                uint32_t b = bits & (0u - bits);
+                assert(!implicant_within({p.care & ~b, p.value & ~b}, t, n));
+            }
+        }
+    }
+    std::cout << "\033[0;32m✓ Every implicant found is prime\033[0m" << std::endl;
+}
+
+void test_random() {
+    std::cout << "\n\033[0;33mRandom Formula Tests----------------------\033[0m" << std::endl;
+
+    // exact up to kExactVariables, Espresso-style above, both equivalent
+    int cases = 0;
+    size_t cubes = 0;
+    for (int variables : {3, 6, 9, 12, 14}) {
+        for (FormulaShape shape : {FormulaShape::RANDOM, FormulaShape::XOR_HEAVY, FormulaShape::CNF_LIKE}) {
+            GeneratorOptions options;
+            options.variables = variables;
+            options.depth = 5;
+            options.shape = shape;
+            options.clauses = 6;
+            FormulaGenerator gen(variables * 10 + static_cast<int>(shape), options);
+            for (int i = 0; i < 12; ++i, ++cases) {
+                std::string f = gen.next();
+                int n;
+                std::vector<uint64_t> t = minterm_table(f, n);
+                std::vector<Implicant> cover = minimize_cover(t, n);
+                assert(cover_table(cover, n) == t);
+                cubes += cover.size();
+
+                std::vector<uint64_t> complement(t);
+                for (uint64_t &w : complement) w = ~w;
+                assert(cover_table(minimize_cover(complement, n), n) == complement);
+
+                if (variables <= 9) {
+                    assert(equivalent(f, minimize(f)) && equivalent(f, minimize(f, MINIMIZE_POS)));
+                }
+            }
+        }
+    }
+    std::cout << cases << " formulas of 3 to 14 variables, " << cubes << " cubes in all" << std::endl;
+    std::cout << "\033[0;32m✓ Minimized forms are equivalent\033[0m" << std::endl;
+
+    // the heuristic stays close to the exact answer
+    size_t exact = 0, heuristic = 0;
+    GeneratorOptions options;
+    options.variables = 8;
+    options.depth = 5;
+    FormulaGenerator gen(99, options);
+    for (int i = 0; i < 100; ++i) {
+        int n;
+        std::vector<uint64_t> t = minterm_table(gen.next(), n);
+        std::vector<Implicant> initial;
+        isop(t, t, n, {0, 0}, initial);
+        exact += minimize_cover(t, n).size();
+        heuristic += CoverRefiner(t, n).refine(initial).size();
+    }
+    std::cout << "8 variables, 100 functions: " << exact << " exact cubes, " << heuristic << " heuristic" << std::endl;
+    assert(heuristic <= exact + exact / 20);
+    std::cout << "\033[0;32m✓ Espresso-style cover within 5% of exact\033[0m" << std::endl;
+}
+
+void test_limits() {
+    std::cout << "\n\033[0;33mLimit Tests-------------------------------\033[0m" << std::endl;
+
+    // A..T under XOR and OR: 20 variables, far too much work to finish, and
+    // limits that have already run out so the result does not depend on speed
+    std::string big = "A";
+    for (char c = 'B'; c <= 'T'; ++c) big += std::string(1, c) + (c % 3 ? '^' : '|');
+    ResourceLimits expired;
+    expired.deadline = std::chrono::steady_clock::now() - std::chrono::seconds(1);
+    Limited<std::string> r = minimize(big, MINIMIZE_SOP, expired);
+    std::cout << "20 variables, expired deadline: " << limit_status_name(r.status) << std::endl;
+    assert(r.status == LIMIT_DEADLINE);
+
+    CancellationToken token;
+    token.cancel();
+    ResourceLimits cancelled;
+    cancelled.cancel = &token;
+    r = minimize(big, MINIMIZE_POS, cancelled);
+    std::cout << "20 variables, cancelled token: " << limit_status_name(r.status) << std::endl;
+    assert(r.status == LIMIT_CANCELLED);
+
+    bool threw = false;
+    try {
+        minimize("ABCDEFGHIJKLMNOPQRSTU&&&&&&&&&&&&&&&&&&&&");
+    } catch (const std::invalid_argument &e) {
+        std::cout << e.what() << std::endl;
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "\033[0;32m✓ Deadlines and the variable limit\033[0m" << std::endl;
+}
+
+int main() {
+    test_small();
+    test_quine_mccluskey();
+    test_random();
+    test_limits();
+    return 0;
+}
@@ -0,0 +1,172 @@
+// portfolio SAT main
+
+#include <cassert>
+#include <random>
+#include "../sat_portfolio.hpp"
+#include "../formula_generator.hpp"
+
+ClauseSet pigeonhole(uint32_t holes) {
+    ClauseSet set;
+    auto var = [&](uint32_t pigeon, uint32_t hole) { return pigeon * holes + hole; };
+    for (uint32_t p = 0; p <= holes; ++p) {
+        std::vector<Literal> somewhere;
+        for (uint32_t h = 0; h < holes; ++h) somewhere.push_back(make_literal(var(p, h), false));
+        set.add_clause(somewhere);
+    }
+    for (uint32_t h = 0; h < holes; ++h) {
+        for (uint32_t p = 0; p <= holes; ++p) {
+            for (uint32_t q = p + 1; q <= holes; ++q) {
+                set.add_clause({make_literal(var(p, h), true), make_literal(var(q, h), true)});
+            }
+        }
+    }
+    return set;
+}
+
+ClauseSet random_3sat(uint32_t variables, size_t clauses, uint32_t seed) {
+    std::mt19937 rng(seed);
+    ClauseSet set;
+    while (set.size() < clauses) {
+        Literal c[3];
+        for (Literal &l : c) l = make_literal(rng() % variables, rng() & 1);
+        set.add_clause(c, 3);
+    }
+    return set;
+}
+
+bool model_satisfies(const std::vector<bool> &model, const ClauseSet &set) {
+    for (size_t i = 0; i < set.size(); ++i) {
+        bool satisfied = false;
+        for (Literal l : set.clause(i)) satisfied = satisfied || model[literal_variable(l)] != literal_negated(l);
+        if (!satisfied) return false;
+    }
+    return true;
+}
+
+void test_exchange() {
+    std::cout << "\033[0;33mClause Exchange Tests---------------------\033[0m" << std::endl;
+
+    ClauseExchange exchange(8);
+    Literal a[2] = {make_literal(0, false), make_literal(1, true)};
+    Literal b[1] = {make_literal(2, false)};
+    exchange.publish(0, a, 2);
+    exchange.publish(1, b, 1);
+
+    // each reader sees only the others' clauses, once
+    uint64_t cursor0 = 0, cursor1 = 0;
+    std::vector<size_t> seen0, seen1;
+    exchange.collect(0, cursor0, [&](const Literal *, size_t n) { seen0.push_back(n); });
+    exchange.collect(1, cursor1, [&](const Literal *lits, size_t n) {
+        assert(n == 2 && lits[0] == a[0] && lits[1] == a[1]);
+        seen1.push_back(n);
+    });
+    assert(seen0 == std::vector<size_t>{1} && seen1 == std::vector<size_t>{2});
+    exchange.collect(0, cursor0, [&](const Literal *, size_t n) { seen0.push_back(n); });
+    assert(seen0.size() == 1);
+
+    // a reader that falls a whole buffer behind skips what was overwritten
+    for (int i = 0; i < 20; ++i) exchange.publish(1, b, 1);
+    size_t caught_up = 0;
+    exchange.collect(0, cursor0, [&](const Literal *, size_t) { ++caught_up; });
+    assert(caught_up == 8);
+
+    // too long to share
+    Literal wide[ClauseExchange::kMaxLiterals + 1] = {};
+    uint64_t before = cursor0;
+    exchange.publish(1, wide, ClauseExchange::kMaxLiterals + 1);
+    exchange.collect(0, cursor0, [&](const Literal *, size_t) { assert(false); });
+    assert(cursor0 == before);
+    std::cout << "\033[0;32m✓ Own clauses skipped, lagging readers resynchronize\033[0m" << std::endl;
+}
+
+void test_single_thread() {
+    std::cout << "\n\033[0;33mSingle Thread Fallback Tests--------------\033[0m" << std::endl;
+
+    ClauseSet clauses = random_3sat(150, 630, 3);
+    PortfolioOptions options;
+    options.threads = 1;
+
+    PortfolioResult first = portfolio_solve(clauses, options);
+    PortfolioResult second = portfolio_solve(clauses, options);
+    SatSolver plain;
+    plain.add_clauses(clauses);
+    bool expected = plain.solve();
+
+    std::cout << "150 variables, 630 clauses, one thread: " << (first.satisfiable ? "satisfiable" : "unsatisfiable")
+              << " after " << first.conflicts << " conflicts" << std::endl;
+    assert(first.ok() && first.satisfiable == expected);
+    assert(first.conflicts == second.conflicts && first.model == second.model);
+    assert(first.conflicts == plain.stats().conflicts);
+    assert(!first.satisfiable || first.model == plain.model());
+    std::cout << "\033[0;32m✓ Same run as a plain SatSolver, every time\033[0m" << std::endl;
+}
+
+void test_parallel() {
+    std::cout << "\n\033[0;33mParallel Portfolio Tests------------------\033[0m" << std::endl;
+
+    PortfolioOptions options;
+    options.threads = 4;
+
+    PortfolioResult php = portfolio_solve(pigeonhole(7), options);
+    std::cout << "8 pigeons, 7 holes, 4 threads: solver " << php.winner << " proved it unsatisfiable, "
+              << php.conflicts << " conflicts, " << php.shared_clauses << " clauses shared" << std::endl;
+    assert(php.ok() && !php.satisfiable && php.threads == 4);
+
+    int instances = 0;
+    for (uint32_t seed = 1; seed <= 12; ++seed, ++instances) {
+        ClauseSet clauses = random_3sat(120, 510, seed);
+        PortfolioResult r = portfolio_solve(clauses, options);
+        SatSolver plain;
+        plain.add_clauses(clauses);
+        assert(r.ok() && r.satisfiable == plain.solve());
+        assert(!r.satisfiable || model_satisfies(r.model, clauses));
+    }
+    std::cout << instances << " random 3-SAT instances agree with a single solver" << std::endl;
+
+    // assumptions go to every solver
+    ClauseSet implication;
+    implication.add_clause({make_literal(0, true), make_literal(1, false)});
+    PortfolioResult r = portfolio_solve(implication, {make_literal(0, false), make_literal(1, true)}, options);
+    assert(r.ok() && !r.satisfiable);
+    std::cout << "\033[0;32m✓ Four solvers, one answer\033[0m" << std::endl;
+
+    GeneratorOptions shape;
+    shape.shape = FormulaShape::CNF_LIKE;
+    shape.variables = 6;
+    shape.clauses = 10;
+    FormulaGenerator gen(5, shape);
+    for (int i = 0; i < 50; ++i) {
+        std::string f = gen.next();
+        assert(sat(f, options) == sat(f));
+    }
+    std::cout << "\033[0;32m✓ sat(formula, options) matches sat(formula)\033[0m" << std::endl;
+}
+
+void test_limits() {
+    std::cout << "\n\033[0;33mPortfolio Limit Tests---------------------\033[0m" << std::endl;
+
+    PortfolioOptions options;
+    options.threads = 4;
+    ClauseSet hard = pigeonhole(10);
+
+    auto start = std::chrono::steady_clock::now();
+    PortfolioResult r = portfolio_solve(hard, options, ResourceLimits::timeout(std::chrono::milliseconds(50)));
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "11 pigeons, 10 holes, 50 ms: " << limit_status_name(r.status) << " after " << ms << " ms" << std::endl;
+    assert(r.status == LIMIT_DEADLINE && ms < 2000);
+
+    CancellationToken token;
+    token.cancel();
+    ResourceLimits limits;
+    limits.cancel = &token;
+    assert(sat("AB&C|", options, limits).status == LIMIT_CANCELLED);
+    std::cout << "\033[0;32m✓ Deadlines and cancellation stop every solver\033[0m" << std::endl;
+}
+
+int main() {
+    test_exchange();
+    test_single_thread();
+    test_parallel();
+    test_limits();
+    return 0;
+}
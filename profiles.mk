@@ -0,0 +1,45 @@
+# **************************************************************************** #
+#                                                                              #
+#    profiles.mk: compiler flags per build profile, shared by every Makefile   #
+#                                                                              #
+# **************************************************************************** #
+
+# -=-=-=-=-    PROFILES -=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=- #
+#
+#   debug           -g + AddressSanitizer (the default for the test programs)
+#   release         -O3, -march, LTO
+#   relwithdebinfo  -O2 -g with frame pointers, for perf/flame graphs
+#   pgo-generate    release + instrumentation writing profiles to PGO_DIR
+#   pgo-use         release + the profiles collected in PGO_DIR
+#
+# NDEBUG is left to each Makefile: the test programs check with assert in
+# every profile, the library itself has no assertions.
+
+ROOT_DIR    := $(abspath $(dir $(lastword $(MAKEFILE_LIST))))
+
+PROFILE     ?= debug
+MARCH       ?= -march=native
+PGO_DIR     ?= $(ROOT_DIR)/build/pgo-data
+
+RELEASE_FLAGS = -O3 $(MARCH) -flto=auto
+
+ifeq ($(PROFILE),debug)
+PROFILE_FLAGS   = -g -fsanitize=address
+else ifeq ($(PROFILE),release)
+PROFILE_FLAGS   = $(RELEASE_FLAGS)
+else ifeq ($(PROFILE),relwithdebinfo)
+PROFILE_FLAGS   = -O2 -g -fno-omit-frame-pointer -mno-omit-leaf-frame-pointer
+else ifeq ($(PROFILE),pgo-generate)
+PROFILE_FLAGS   = $(RELEASE_FLAGS) -fprofile-generate=$(PGO_DIR) -fprofile-update=atomic
+else ifeq ($(PROFILE),pgo-use)
+PROFILE_FLAGS   = $(RELEASE_FLAGS) -fprofile-use=$(PGO_DIR) -fprofile-correction -Wno-missing-profile
+else
+$(error Unknown PROFILE '$(PROFILE)': use debug, release, relwithdebinfo, pgo-generate or pgo-use)
+endif
+
+# both PGO phases must compile to the same object paths for the profiles to match
+ifneq (,$(filter pgo-%,$(PROFILE)))
+PROFILE_OBJ     = pgo
+else
+PROFILE_OBJ     = $(PROFILE)
+endif
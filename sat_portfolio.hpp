@@ -0,0 +1,145 @@
+#ifndef SAT_PORTFOLIO_HPP
+#define SAT_PORTFOLIO_HPP
+
+#include <exception>
+#include <thread>
+#include "sat_solver.hpp"
+
+// Parallel portfolio SAT.
+//
+// Several SatSolvers with different seeds, restart policies, initial phases
+// and decay rates race on the same clauses, one per thread, passing each
+// other learned clauses of low literal block distance through a
+// ClauseExchange. The first to finish stops the others. Solver 0 always has
+// the default configuration, so one thread is exactly a plain SatSolver run
+// on the calling thread, with deterministic results.
+
+struct PortfolioOptions {
+    unsigned threads = 0;           // 0 for one per hardware thread
+    uint64_t seed = 1;              // varies the configurations of solvers 1 and up
+    bool share_clauses = true;
+    uint32_t share_lbd = 2;         // share learned clauses of at most this many levels
+};
+
+struct PortfolioResult {
+    LimitStatus status = LIMIT_OK;
+    bool satisfiable = false;
+    std::vector<bool> model;        // when satisfiable
+    unsigned threads = 0;
+    unsigned winner = 0;            // the solver that answered
+    uint64_t conflicts = 0;         // over all solvers
+    uint64_t shared_clauses = 0;    // imported over all solvers
+
+    bool ok() const { return status == LIMIT_OK; }
+};
+
+inline unsigned portfolio_threads(const PortfolioOptions &options) {
+    if (options.threads > 0) return options.threads;
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Solver i's configuration: 0 is the default, the others cycle through the
+// restart policies, phases and decay rates, each with its own seed
+inline SatSolverConfig portfolio_config(unsigned index, uint64_t seed) {
+    SatSolverConfig config;
+    if (index == 0) return config;
+
+    static const double decays[] = {0.95, 0.9, 0.99, 0.85};
+    config.seed = seed * 0x9E3779B97F4A7C15ull + index;
+    config.restarts = index % 2 ? RESTART_GEOMETRIC : RESTART_LUBY;
+    config.phase = static_cast<PhasePolicy>(index % 3);
+    config.activity_decay = decays[index % 4];
+    config.random_decisions = index % 4 == 3 ? 0.05 : 0.01;
+    return config;
+}
+
+inline PortfolioResult portfolio_solve(const ClauseSet &clauses, const std::vector<Literal> &assumptions,
+                                       const PortfolioOptions &options, const ResourceLimits &limits = ResourceLimits()) {
+    PortfolioResult result;
+    result.threads = portfolio_threads(options);
+
+    if (result.threads == 1) {
+        SatSolver solver;
+        solver.add_clauses(clauses);
+        Limited<bool> r = solver.solve(assumptions, limits);
+        result.status = r.status;
+        result.satisfiable = r.ok() && r.value;
+        if (result.satisfiable) result.model = solver.model();
+        result.conflicts = solver.stats().conflicts;
+        return result;
+    }
+
+    ClauseExchange exchange;
+    CancellationToken stop;
+    std::atomic<bool> answered{false};
+    std::vector<std::unique_ptr<SatSolver>> solvers(result.threads);
+    std::vector<LimitStatus> statuses(result.threads, LIMIT_OK);
+    std::vector<std::exception_ptr> errors(result.threads);
+
+    auto worker = [&](unsigned i) {
+        try {
+            solvers[i] = std::make_unique<SatSolver>(portfolio_config(i, options.seed));
+            SatSolver &solver = *solvers[i];
+            solver.set_stop(&stop);
+            if (options.share_clauses) solver.share_clauses(&exchange, i, options.share_lbd);
+            solver.add_clauses(clauses);
+
+            Limited<bool> r = solver.solve(assumptions, limits);
+            statuses[i] = r.status;
+            bool expected = false;
+            if (r.ok() && answered.compare_exchange_strong(expected, true)) {
+                result.winner = i;
+                result.satisfiable = r.value;
+                if (r.value) result.model = solver.model();
+                stop.cancel();
+            }
+        } catch (...) {
+            errors[i] = std::current_exception();
+            stop.cancel();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 0; i < result.threads; ++i) pool.emplace_back(worker, i);
+    for (std::thread &t : pool) t.join();
+
+    for (std::exception_ptr &e : errors) {
+        if (e) std::rethrow_exception(e);
+    }
+    for (const std::unique_ptr<SatSolver> &solver : solvers) {
+        result.conflicts += solver->stats().conflicts;
+        result.shared_clauses += solver->stats().imported_clauses;
+    }
+    // with no answer, every solver stopped on the caller's limits
+    if (!answered) result.status = statuses[0];
+    return result;
+}
+
+inline PortfolioResult portfolio_solve(const ClauseSet &clauses, const PortfolioOptions &options,
+                                       const ResourceLimits &limits = ResourceLimits()) {
+    return portfolio_solve(clauses, {}, options, limits);
+}
+
+// sat() through the portfolio, on the formula's clause-set CNF
+inline bool sat(const std::string &formula, const PortfolioOptions &options) {
+    try {
+        return portfolio_solve(conjunctive_normal_form_clauses(formula), options).satisfiable;
+    } catch (const std::exception &e) {
+        std::cerr << "Error in SAT evaluation: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+inline Limited<bool> sat(const std::string &formula, const PortfolioOptions &options, const ResourceLimits &limits) {
+    try {
+        Limited<ClauseSet> clauses = conjunctive_normal_form_clauses(formula, limits);
+        if (!clauses.ok()) return {clauses.status, false};
+        PortfolioResult r = portfolio_solve(clauses.value, options, limits);
+        return {r.status, r.satisfiable};
+    } catch (const std::exception &e) {
+        std::cerr << "Error in SAT evaluation: " << e.what() << std::endl;
+        return {LIMIT_OK, false};
+    }
+}
+
+#endif
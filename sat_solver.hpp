@@ -0,0 +1,739 @@
+#ifndef SAT_SOLVER_HPP
+#define SAT_SOLVER_HPP
+
+#include <random>
+#include "clause_set.hpp"
+
+// Incremental CDCL SAT solver.
+//
+// Clauses are loaded once and solve() is called as often as needed, each
+// call under its own assumptions: literals taken as the first decisions of
+// the search. Learned clauses follow from the clauses alone, never from the
+// assumptions, so they are kept from one call to the next, and clauses can
+// be added between calls. When a call is unsatisfiable under its
+// assumptions, failed_assumptions() holds the ones the refutation used.
+//
+// The search uses two watched literals per clause, first-UIP learning with
+// clause minimization, VSIDS branching with phase saving and Luby restarts.
+// Learned clauses are pruned by literal block distance (the number of
+// decision levels among their literals) at restarts. Clauses share one flat
+// arena, a two-word header followed by the literals.
+//
+// SatSolverConfig varies the search (seed, restarts, initial phase, decay)
+// for solvers racing on one problem, and a ClauseExchange lets such solvers
+// pass each other their short learned clauses.
+
+enum RestartPolicy {
+    RESTART_LUBY,           // 100 conflicts times 1, 1, 2, 1, 1, 2, 4, ...
+    RESTART_GEOMETRIC       // 100 conflicts, growing by half each restart
+};
+
+enum PhasePolicy {
+    PHASE_FALSE,            // variables are first tried false
+    PHASE_TRUE,
+    PHASE_RANDOM
+};
+
+struct SatSolverConfig {
+    uint64_t seed = 0;                  // random phases and decisions; 0 starts all activities at zero
+    RestartPolicy restarts = RESTART_LUBY;
+    PhasePolicy phase = PHASE_FALSE;
+    double activity_decay = 0.95;
+    double random_decisions = 0.0;      // fraction of decisions on a random variable
+};
+
+// Learned clauses passed between solvers on different threads. Publishers
+// claim a ticket and fill the slot it maps to; each reader keeps its own
+// cursor. Slots carry a sequence number, odd while being written, so a
+// reader discards anything torn or overwritten, and a publisher that finds
+// its slot busy drops the clause: sharing is best effort, nobody waits.
+class ClauseExchange {
+public:
+    static constexpr size_t kMaxLiterals = 8;
+
+    explicit ClauseExchange(size_t capacity = 4096) : slots_(capacity) {}
+
+    ClauseExchange(const ClauseExchange &) = delete;
+    ClauseExchange &operator=(const ClauseExchange &) = delete;
+
+    void publish(uint32_t source, const Literal *lits, size_t count) {
+        if (count > kMaxLiterals) return;
+        uint64_t ticket = head_.fetch_add(1, std::memory_order_relaxed);
+        Slot &slot = slots_[ticket % slots_.size()];
+
+        uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+        if ((sequence & 1) || !slot.sequence.compare_exchange_strong(sequence, 2 * ticket + 1, std::memory_order_relaxed)) {
+            return;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.source.store(source, std::memory_order_relaxed);
+        slot.size.store(static_cast<uint32_t>(count), std::memory_order_relaxed);
+        for (size_t i = 0; i < count; ++i) slot.literals[i].store(lits[i], std::memory_order_relaxed);
+        slot.sequence.store(2 * ticket + 2, std::memory_order_release);
+    }
+
+    // Calls f(literals, count) for each clause other sources published
+    // since the reader's cursor, then advances it
+    template <typename F>
+    void collect(uint32_t reader, uint64_t &cursor, F &&f) const {
+        uint64_t head = head_.load(std::memory_order_acquire);
+        if (head - cursor > slots_.size()) cursor = head - slots_.size();
+
+        Literal lits[kMaxLiterals];
+        for (; cursor < head; ++cursor) {
+            const Slot &slot = slots_[cursor % slots_.size()];
+            uint64_t before = slot.sequence.load(std::memory_order_acquire);
+            if (before == 2 * cursor + 1) break;        // still being written: next time
+            if (before != 2 * cursor + 2) continue;     // dropped or overwritten
+
+            uint32_t source = slot.source.load(std::memory_order_relaxed);
+            uint32_t count = std::min<uint32_t>(slot.size.load(std::memory_order_relaxed), kMaxLiterals);
+            for (uint32_t i = 0; i < count; ++i) lits[i] = slot.literals[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != before || source == reader) continue;
+            f(static_cast<const Literal *>(lits), static_cast<size_t>(count));
+        }
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<uint32_t> source{0};
+        std::atomic<uint32_t> size{0};
+        std::atomic<Literal> literals[kMaxLiterals];
+    };
+
+    std::vector<Slot> slots_;
+    alignas(64) std::atomic<uint64_t> head_{0};
+};
+
+struct SatSolverStats {
+    uint64_t solves = 0;
+    uint64_t decisions = 0;
+    uint64_t propagations = 0;
+    uint64_t conflicts = 0;
+    uint64_t restarts = 0;
+    uint64_t learnt_clauses = 0;        // learned in total, kept or not
+    uint64_t deleted_clauses = 0;       // learned clauses pruned
+    uint64_t exported_clauses = 0;      // published to a ClauseExchange
+    uint64_t imported_clauses = 0;      // taken from one
+};
+
+class SatSolver {
+public:
+    explicit SatSolver(const SatSolverConfig &config = SatSolverConfig())
+        : config_(config), rng_(config.seed) {}
+
+    const SatSolverConfig &config() const { return config_; }
+    uint32_t variables() const { return static_cast<uint32_t>(assigns_.size()); }
+    size_t clause_count() const { return clauses_.size(); }
+    size_t learnt_count() const { return learnts_.size(); }
+    // false once the clauses alone are unsatisfiable
+    bool okay() const { return ok_; }
+    const SatSolverStats &stats() const { return stats_; }
+
+    void reserve_variables(uint32_t count) {
+        while (variables() < count) new_variable();
+    }
+
+    // Returns false when the solver is left unsatisfiable whatever the
+    // assumptions. Clauses satisfied by the top-level assignment are
+    // dropped and literals it falsifies removed.
+    bool add_clause(const Literal *first, size_t count) {
+        return insert_clause(first, count, false);
+    }
+
+    bool add_clause(std::initializer_list<Literal> clause) {
+        return add_clause(clause.begin(), clause.size());
+    }
+
+    bool add_clause(const std::vector<Literal> &clause) {
+        return add_clause(clause.data(), clause.size());
+    }
+
+    bool add_clauses(const ClauseSet &set) {
+        reserve_variables(set.variables());
+        if (set.has_empty_clause()) ok_ = false;
+        for (size_t i = 0; i < set.size() && ok_; ++i) {
+            ClauseView c = set.clause(i);
+            add_clause(c.data, c.size());
+        }
+        return ok_;
+    }
+
+    // an RPN formula over A-Z, through its clause-set CNF
+    bool add_formula(const std::string &rpn) {
+        return add_clauses(conjunctive_normal_form_clauses(rpn));
+    }
+
+    bool solve(const std::vector<Literal> &assumptions = {}) {
+        ++stats_.solves;
+        model_.clear();
+        failed_.clear();
+        if (!ok_) return false;
+        for (Literal a : assumptions) reserve_variables(literal_variable(a) + 1);
+        if (learnt_limit_ == 0) learnt_limit_ = std::max<size_t>(2000, clauses_.size() / 3);
+
+        try {
+            uint8_t status = kUndef;
+            double geometric = kRestartUnit;
+            for (uint32_t restart = 0; status == kUndef; ++restart) {
+                uint64_t budget = luby(restart) * kRestartUnit;
+                if (config_.restarts == RESTART_GEOMETRIC) {
+                    budget = static_cast<uint64_t>(geometric);
+                    geometric *= 1.5;
+                }
+                status = search(budget, assumptions);
+                if (status == kUndef) {
+                    ++stats_.restarts;
+                    if (exchange_) import_shared();
+                    if (!ok_) status = kFalse;
+                    else if (learnts_.size() >= learnt_limit_) reduce_learnts();
+                }
+            }
+            cancel_until(0);
+            return status == kTrue;
+        } catch (...) {
+            // a limit stopped the search: learned clauses are still valid
+            cancel_until(0);
+            throw;
+        }
+    }
+
+    Limited<bool> solve(const std::vector<Literal> &assumptions, const ResourceLimits &limits) {
+        return run_with_limits<bool>(limits, [&] { return solve(assumptions); });
+    }
+
+    // Publish learned clauses of at most max_lbd levels (and at most
+    // ClauseExchange::kMaxLiterals literals) under this id, and take in the
+    // others' at each restart. Every solver on the exchange must hold the
+    // same clauses.
+    void share_clauses(ClauseExchange *exchange, uint32_t id, uint32_t max_lbd = 2) {
+        exchange_ = exchange;
+        exchange_id_ = id;
+        exchange_cursor_ = 0;
+        share_lbd_ = max_lbd;
+    }
+
+    // A token that stops solve() from another thread: the call ends as if
+    // cancelled through ResourceLimits
+    void set_stop(const CancellationToken *stop) { stop_ = stop; }
+
+    // after a satisfiable solve(): one value per variable
+    const std::vector<bool> &model() const { return model_; }
+    bool model_value(uint32_t variable) const { return model_[variable]; }
+
+    // after an unsatisfiable solve(): the assumptions the refutation used,
+    // empty when the clauses are unsatisfiable on their own
+    const std::vector<Literal> &failed_assumptions() const { return failed_; }
+
+private:
+    using CRef = uint32_t;
+
+    struct Watch {
+        CRef cref;
+        Literal blocker;    // another literal of the clause; true means nothing to do
+    };
+
+    static constexpr CRef kNoReason = UINT32_MAX;
+    static constexpr Literal kNoLiteral = UINT32_MAX;
+    static constexpr uint8_t kFalse = 0;
+    static constexpr uint8_t kTrue = 1;
+    static constexpr uint8_t kUndef = 2;
+    static constexpr uint64_t kRestartUnit = 100;     // conflicts
+
+    SatSolverConfig config_;
+    std::mt19937_64 rng_;
+    bool ok_ = true;
+    std::vector<uint32_t> arena_;
+    std::vector<CRef> clauses_;
+    std::vector<CRef> learnts_;
+    size_t learnt_limit_ = 0;
+
+    std::vector<std::vector<Watch>> watches_;   // by literal: clauses watching it
+    std::vector<uint8_t> assigns_;              // by variable
+    std::vector<uint32_t> level_;
+    std::vector<CRef> reason_;
+    std::vector<uint8_t> polarity_;             // saved phase, 1 for negated
+    std::vector<uint8_t> seen_;
+    std::vector<Literal> trail_;
+    std::vector<size_t> trail_lim_;             // trail size at each decision
+    size_t qhead_ = 0;
+
+    std::vector<double> activity_;
+    double activity_inc_ = 1.0;
+    std::vector<uint32_t> heap_;                // unassigned variables, most active first
+    std::vector<int32_t> heap_index_;
+
+    std::vector<Literal> add_buffer_;
+    std::vector<Literal> learnt_;
+    std::vector<Literal> analyze_clear_;
+    std::vector<uint64_t> level_stamp_;
+    uint64_t stamp_ = 0;
+
+    std::vector<bool> model_;
+    std::vector<Literal> failed_;
+    SatSolverStats stats_;
+
+    ClauseExchange *exchange_ = nullptr;
+    uint32_t exchange_id_ = 0;
+    uint64_t exchange_cursor_ = 0;
+    uint32_t share_lbd_ = 2;
+    const CancellationToken *stop_ = nullptr;
+
+    // clause arena: size, then (lbd << 2) | deleted << 1 | learnt, then literals
+    uint32_t clause_size(CRef c) const { return arena_[c]; }
+    Literal *clause_literals(CRef c) { return arena_.data() + c + 2; }
+    bool clause_learnt(CRef c) const { return arena_[c + 1] & 1; }
+    bool clause_deleted(CRef c) const { return arena_[c + 1] & 2; }
+    uint32_t clause_lbd(CRef c) const { return arena_[c + 1] >> 2; }
+
+    CRef allocate(const std::vector<Literal> &lits, bool learnt, uint32_t lbd) {
+        CRef cref = static_cast<CRef>(arena_.size());
+        arena_.push_back(static_cast<uint32_t>(lits.size()));
+        arena_.push_back((lbd << 2) | (learnt ? 1u : 0u));
+        arena_.insert(arena_.end(), lits.begin(), lits.end());
+        return cref;
+    }
+
+    void attach(CRef c) {
+        Literal *lits = clause_literals(c);
+        watches_[lits[0]].push_back({c, lits[1]});
+        watches_[lits[1]].push_back({c, lits[0]});
+    }
+
+    // Normalizes the clause against the top-level assignment and stores it;
+    // called at level 0 only
+    bool insert_clause(const Literal *first, size_t count, bool learnt) {
+        if (!ok_) return false;
+
+        std::vector<Literal> &c = add_buffer_;
+        c.assign(first, first + count);
+        std::sort(c.begin(), c.end());
+        c.erase(std::unique(c.begin(), c.end()), c.end());
+        if (!c.empty()) reserve_variables(literal_variable(c.back()) + 1);
+
+        size_t j = 0;
+        for (size_t i = 0; i < c.size(); ++i) {
+            if (i + 1 < c.size() && c[i + 1] == negate_literal(c[i])) return true;
+            uint8_t value = literal_value(c[i]);
+            if (value == kTrue) return true;
+            if (value == kUndef) c[j++] = c[i];
+        }
+        c.resize(j);
+
+        if (c.empty()) return ok_ = false;
+        if (c.size() == 1) {
+            enqueue(c[0], kNoReason);
+            return ok_ = propagate() == kNoReason;
+        }
+        CRef cref = allocate(c, learnt, learnt ? static_cast<uint32_t>(c.size()) : 0);
+        (learnt ? learnts_ : clauses_).push_back(cref);
+        attach(cref);
+        return true;
+    }
+
+    uint32_t decision_level() const { return static_cast<uint32_t>(trail_lim_.size()); }
+
+    uint8_t literal_value(Literal l) const {
+        uint8_t a = assigns_[literal_variable(l)];
+        return a == kUndef ? kUndef : static_cast<uint8_t>(a ^ (l & 1));
+    }
+
+    void new_variable() {
+        uint32_t v = variables();
+        assigns_.push_back(kUndef);
+        level_.push_back(0);
+        reason_.push_back(kNoReason);
+        polarity_.push_back(config_.phase == PHASE_RANDOM ? rng_() & 1 : config_.phase == PHASE_FALSE);
+        seen_.push_back(0);
+        // a seeded solver starts from a slightly shuffled variable order
+        activity_.push_back(config_.seed ? std::uniform_real_distribution<double>(0.0, 1e-5)(rng_) : 0.0);
+        heap_index_.push_back(-1);
+        watches_.resize(2 * (v + 1));
+        heap_insert(v);
+    }
+
+    void enqueue(Literal l, CRef reason) {
+        uint32_t v = literal_variable(l);
+        assigns_[v] = literal_negated(l) ? kFalse : kTrue;
+        level_[v] = decision_level();
+        reason_[v] = reason;
+        trail_.push_back(l);
+    }
+
+    void cancel_until(uint32_t level) {
+        if (decision_level() <= level) return;
+        for (size_t i = trail_.size(); i-- > trail_lim_[level];) {
+            uint32_t v = literal_variable(trail_[i]);
+            assigns_[v] = kUndef;
+            polarity_[v] = literal_negated(trail_[i]);
+            heap_insert(v);
+        }
+        trail_.resize(trail_lim_[level]);
+        trail_lim_.resize(level);
+        qhead_ = trail_.size();
+    }
+
+    // Unit propagation over the watch lists; returns the conflicting clause
+    // or kNoReason. A clause's implied literal is moved to position 0, which
+    // analyze() relies on.
+    CRef propagate() {
+        CRef conflict = kNoReason;
+        while (qhead_ < trail_.size()) {
+            Literal false_lit = negate_literal(trail_[qhead_++]);
+            std::vector<Watch> &ws = watches_[false_lit];
+            ++stats_.propagations;
+
+            size_t i = 0, j = 0;
+            while (i < ws.size()) {
+                Watch w = ws[i];
+                if (literal_value(w.blocker) == kTrue) {
+                    ws[j++] = ws[i++];
+                    continue;
+                }
+
+                Literal *lits = clause_literals(w.cref);
+                if (lits[0] == false_lit) std::swap(lits[0], lits[1]);
+                ++i;
+
+                Literal first = lits[0];
+                Watch keep{w.cref, first};
+                if (first != w.blocker && literal_value(first) == kTrue) {
+                    ws[j++] = keep;
+                    continue;
+                }
+
+                uint32_t size = clause_size(w.cref);
+                bool moved = false;
+                for (uint32_t k = 2; k < size; ++k) {
+                    if (literal_value(lits[k]) != kFalse) {
+                        lits[1] = lits[k];
+                        lits[k] = false_lit;
+                        watches_[lits[1]].push_back(keep);
+                        moved = true;
+                        break;
+                    }
+                }
+                if (moved) continue;
+
+                ws[j++] = keep;
+                if (literal_value(first) == kFalse) {
+                    conflict = w.cref;
+                    qhead_ = trail_.size();
+                    while (i < ws.size()) ws[j++] = ws[i++];
+                } else {
+                    enqueue(first, w.cref);
+                }
+            }
+            ws.resize(j);
+            if (conflict != kNoReason) break;
+        }
+        return conflict;
+    }
+
+    // First-UIP conflict analysis into learnt_, with each literal dropped
+    // whose reason is covered by the rest of the clause. Leaves the
+    // asserting literal at 0 and the highest other level at 1.
+    uint32_t analyze(CRef conflict, uint32_t &lbd) {
+        learnt_.clear();
+        learnt_.push_back(kNoLiteral);
+        int open = 0;
+        Literal p = kNoLiteral;
+        size_t index = trail_.size();
+
+        do {
+            Literal *lits = clause_literals(conflict);
+            uint32_t size = clause_size(conflict);
+            for (uint32_t k = (p == kNoLiteral ? 0 : 1); k < size; ++k) {
+                uint32_t v = literal_variable(lits[k]);
+                if (seen_[v] || level_[v] == 0) continue;
+                bump_activity(v);
+                seen_[v] = 1;
+                if (level_[v] >= decision_level()) ++open;
+                else learnt_.push_back(lits[k]);
+            }
+            while (!seen_[literal_variable(trail_[--index])]) {}
+            p = trail_[index];
+            conflict = reason_[literal_variable(p)];
+            seen_[literal_variable(p)] = 0;
+            --open;
+        } while (open > 0);
+        learnt_[0] = negate_literal(p);
+
+        analyze_clear_.assign(learnt_.begin() + 1, learnt_.end());
+        size_t j = 1;
+        for (size_t i = 1; i < learnt_.size(); ++i) {
+            CRef r = reason_[literal_variable(learnt_[i])];
+            bool redundant = r != kNoReason;
+            if (redundant) {
+                Literal *lits = clause_literals(r);
+                for (uint32_t k = 1; k < clause_size(r); ++k) {
+                    uint32_t u = literal_variable(lits[k]);
+                    if (!seen_[u] && level_[u] > 0) {
+                        redundant = false;
+                        break;
+                    }
+                }
+            }
+            if (!redundant) learnt_[j++] = learnt_[i];
+        }
+        learnt_.resize(j);
+        for (Literal l : analyze_clear_) seen_[literal_variable(l)] = 0;
+
+        uint32_t backtrack = 0;
+        if (learnt_.size() > 1) {
+            size_t max_i = 1;
+            for (size_t i = 2; i < learnt_.size(); ++i) {
+                if (level_[literal_variable(learnt_[i])] > level_[literal_variable(learnt_[max_i])]) max_i = i;
+            }
+            std::swap(learnt_[1], learnt_[max_i]);
+            backtrack = level_[literal_variable(learnt_[1])];
+        }
+
+        level_stamp_.resize(decision_level() + 1);
+        ++stamp_;
+        lbd = 0;
+        for (Literal l : learnt_) {
+            uint32_t level = level_[literal_variable(l)];
+            if (level_stamp_[level] != stamp_) {
+                level_stamp_[level] = stamp_;
+                ++lbd;
+            }
+        }
+        return backtrack;
+    }
+
+    // Assumption p is false: collect the assumptions that imply !p
+    void analyze_final(Literal p) {
+        failed_.assign(1, p);
+        if (decision_level() == 0) return;
+
+        seen_[literal_variable(p)] = 1;
+        for (size_t i = trail_.size(); i-- > trail_lim_[0];) {
+            uint32_t v = literal_variable(trail_[i]);
+            if (!seen_[v]) continue;
+            CRef r = reason_[v];
+            if (r == kNoReason) {
+                failed_.push_back(trail_[i]);
+            } else {
+                Literal *lits = clause_literals(r);
+                for (uint32_t k = 1; k < clause_size(r); ++k) {
+                    if (level_[literal_variable(lits[k])] > 0) seen_[literal_variable(lits[k])] = 1;
+                }
+            }
+            seen_[v] = 0;
+        }
+        seen_[literal_variable(p)] = 0;
+    }
+
+    Literal pick_branch() {
+        if (config_.random_decisions > 0 && !heap_.empty()
+            && std::uniform_real_distribution<double>(0.0, 1.0)(rng_) < config_.random_decisions) {
+            uint32_t v = heap_[rng_() % heap_.size()];
+            if (assigns_[v] == kUndef) return make_literal(v, polarity_[v]);
+        }
+        while (!heap_.empty()) {
+            uint32_t v = heap_pop();
+            if (assigns_[v] == kUndef) return make_literal(v, polarity_[v]);
+        }
+        return kNoLiteral;
+    }
+
+    // Runs until a result or conflict_budget conflicts; kUndef means restart
+    uint8_t search(uint64_t conflict_budget, const std::vector<Literal> &assumptions) {
+        uint64_t conflicts = 0;
+        for (;;) {
+            limit_poll();
+            if (stop_ && stop_->cancelled()) throw ResourceLimitExceeded(LIMIT_CANCELLED);
+            CRef conflict = propagate();
+            if (conflict != kNoReason) {
+                ++stats_.conflicts;
+                ++conflicts;
+                if (decision_level() == 0) {
+                    ok_ = false;
+                    return kFalse;
+                }
+
+                uint32_t lbd;
+                uint32_t backtrack = analyze(conflict, lbd);
+                cancel_until(backtrack);
+                if (learnt_.size() == 1) {
+                    enqueue(learnt_[0], kNoReason);
+                } else {
+                    CRef cref = allocate(learnt_, true, lbd);
+                    learnts_.push_back(cref);
+                    attach(cref);
+                    enqueue(learnt_[0], cref);
+                }
+                ++stats_.learnt_clauses;
+                if (exchange_ && lbd <= share_lbd_ && learnt_.size() <= ClauseExchange::kMaxLiterals) {
+                    exchange_->publish(exchange_id_, learnt_.data(), learnt_.size());
+                    ++stats_.exported_clauses;
+                }
+                activity_inc_ /= config_.activity_decay;
+                continue;
+            }
+
+            if (conflicts >= conflict_budget) {
+                cancel_until(0);
+                return kUndef;
+            }
+
+            Literal next = kNoLiteral;
+            while (decision_level() < assumptions.size()) {
+                Literal a = assumptions[decision_level()];
+                uint8_t value = literal_value(a);
+                if (value == kTrue) {
+                    trail_lim_.push_back(trail_.size());    // already holds: empty level
+                } else if (value == kFalse) {
+                    analyze_final(a);
+                    return kFalse;
+                } else {
+                    next = a;
+                    break;
+                }
+            }
+            if (next == kNoLiteral) {
+                next = pick_branch();
+                if (next == kNoLiteral) {
+                    model_.resize(variables());
+                    for (uint32_t v = 0; v < variables(); ++v) model_[v] = assigns_[v] == kTrue;
+                    return kTrue;
+                }
+                ++stats_.decisions;
+            }
+            trail_lim_.push_back(trail_.size());
+            enqueue(next, kNoReason);
+        }
+    }
+
+    // Other solvers' clauses, added at level 0 as learned ones
+    void import_shared() {
+        exchange_->collect(exchange_id_, exchange_cursor_, [&](const Literal *lits, size_t count) {
+            if (!ok_) return;
+            ++stats_.imported_clauses;
+            insert_clause(lits, count, true);
+        });
+    }
+
+    // Called at level 0 between restarts, where no learned clause is the
+    // reason for an assignment: drops the worse half of the learned clauses
+    // (keeping those with lbd <= 2) and every clause already satisfied
+    void reduce_learnts() {
+        std::sort(learnts_.begin(), learnts_.end(), [&](CRef a, CRef b) {
+            if (clause_lbd(a) != clause_lbd(b)) return clause_lbd(a) < clause_lbd(b);
+            return clause_size(a) < clause_size(b);
+        });
+        for (size_t i = learnts_.size() / 2; i < learnts_.size(); ++i) {
+            if (clause_lbd(learnts_[i]) > 2) {
+                arena_[learnts_[i] + 1] |= 2;
+                ++stats_.deleted_clauses;
+            }
+        }
+        collect_garbage();
+        learnt_limit_ += learnt_limit_ / 10;
+    }
+
+    void collect_garbage() {
+        std::vector<uint32_t> arena;
+        arena.reserve(arena_.size());
+        auto move = [&](std::vector<CRef> &list) {
+            size_t j = 0;
+            for (CRef c : list) {
+                if (clause_deleted(c)) continue;
+                Literal *lits = clause_literals(c);
+                bool satisfied = false;
+                for (uint32_t k = 0; k < clause_size(c) && !satisfied; ++k) {
+                    satisfied = literal_value(lits[k]) == kTrue;
+                }
+                if (satisfied) continue;
+                list[j++] = static_cast<CRef>(arena.size());
+                arena.insert(arena.end(), arena_.begin() + c, arena_.begin() + c + 2 + clause_size(c));
+            }
+            list.resize(j);
+        };
+        move(clauses_);
+        move(learnts_);
+        arena_.swap(arena);
+
+        for (Literal l : trail_) reason_[literal_variable(l)] = kNoReason;
+        for (std::vector<Watch> &ws : watches_) ws.clear();
+        for (CRef c : clauses_) attach(c);
+        for (CRef c : learnts_) attach(c);
+    }
+
+    // 1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1, 1, 2, 4, 8, ...
+    static uint64_t luby(uint32_t i) {
+        uint64_t size = 1;
+        uint32_t seq = 0;
+        while (size < i + 1) {
+            ++seq;
+            size = 2 * size + 1;
+        }
+        while (size - 1 != i) {
+            size = (size - 1) >> 1;
+            --seq;
+            i = static_cast<uint32_t>(i % size);
+        }
+        return uint64_t(1) << seq;
+    }
+
+    void bump_activity(uint32_t v) {
+        if ((activity_[v] += activity_inc_) > 1e100) {
+            for (double &a : activity_) a *= 1e-100;
+            activity_inc_ *= 1e-100;
+        }
+        if (heap_index_[v] >= 0) heap_up(static_cast<size_t>(heap_index_[v]));
+    }
+
+    void heap_insert(uint32_t v) {
+        if (heap_index_[v] >= 0) return;
+        heap_index_[v] = static_cast<int32_t>(heap_.size());
+        heap_.push_back(v);
+        heap_up(heap_.size() - 1);
+    }
+
+    uint32_t heap_pop() {
+        uint32_t top = heap_[0];
+        heap_index_[top] = -1;
+        uint32_t last = heap_.back();
+        heap_.pop_back();
+        if (!heap_.empty()) {
+            heap_[0] = last;
+            heap_index_[last] = 0;
+            heap_down(0);
+        }
+        return top;
+    }
+
+    void heap_up(size_t i) {
+        uint32_t v = heap_[i];
+        while (i > 0) {
+            size_t parent = (i - 1) / 2;
+            if (activity_[heap_[parent]] >= activity_[v]) break;
+            heap_[i] = heap_[parent];
+            heap_index_[heap_[i]] = static_cast<int32_t>(i);
+            i = parent;
+        }
+        heap_[i] = v;
+        heap_index_[v] = static_cast<int32_t>(i);
+    }
+
+    void heap_down(size_t i) {
+        uint32_t v = heap_[i];
+        for (;;) {
+            size_t child = 2 * i + 1;
+            if (child >= heap_.size()) break;
+            if (child + 1 < heap_.size() && activity_[heap_[child + 1]] > activity_[heap_[child]]) ++child;
+            if (activity_[heap_[child]] <= activity_[v]) break;
+            heap_[i] = heap_[child];
+            heap_index_[heap_[i]] = static_cast<int32_t>(i);
+            i = child;
+        }
+        heap_[i] = v;
+        heap_index_[v] = static_cast<int32_t>(i);
+    }
+};
+
+#endif
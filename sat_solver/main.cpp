@@ -0,0 +1,224 @@
+// incremental SAT solver main
+
+#include <cassert>
+#include <random>
+#include "../sat_solver.hpp"
+#include "../formula_generator.hpp"
+
+Literal pos(char v) { return make_literal(v - 'A', false); }
+Literal neg(char v) { return make_literal(v - 'A', true); }
+
+// the formula with each assumption conjoined, for the brute-force sat
+std::string with_assumptions(const std::string &f, const std::vector<Literal> &assumptions) {
+    std::string out = f;
+    for (Literal a : assumptions) {
+        out += static_cast<char>('A' + literal_variable(a));
+        if (literal_negated(a)) out += '!';
+        out += '&';
+    }
+    return out;
+}
+
+bool model_satisfies(const SatSolver &solver, const ClauseSet &set) {
+    for (size_t i = 0; i < set.size(); ++i) {
+        bool satisfied = false;
+        for (Literal l : set.clause(i)) {
+            satisfied = satisfied || solver.model_value(literal_variable(l)) != literal_negated(l);
+        }
+        if (!satisfied) return false;
+    }
+    return true;
+}
+
+// n + 1 pigeons in n holes: unsatisfiable, and hard enough to need learning
+ClauseSet pigeonhole(uint32_t holes) {
+    ClauseSet set;
+    auto var = [&](uint32_t pigeon, uint32_t hole) { return pigeon * holes + hole; };
+    for (uint32_t p = 0; p <= holes; ++p) {
+        std::vector<Literal> somewhere;
+        for (uint32_t h = 0; h < holes; ++h) somewhere.push_back(make_literal(var(p, h), false));
+        set.add_clause(somewhere);
+    }
+    for (uint32_t h = 0; h < holes; ++h) {
+        for (uint32_t p = 0; p <= holes; ++p) {
+            for (uint32_t q = p + 1; q <= holes; ++q) {
+                set.add_clause({make_literal(var(p, h), true), make_literal(var(q, h), true)});
+            }
+        }
+    }
+    return set;
+}
+
+ClauseSet random_3sat(uint32_t variables, size_t clauses, uint32_t seed) {
+    std::mt19937 rng(seed);
+    ClauseSet set;
+    while (set.size() < clauses) {
+        Literal c[3];
+        for (Literal &l : c) l = make_literal(rng() % variables, rng() & 1);
+        set.add_clause(c, 3);
+    }
+    return set;
+}
+
+void test_basic() {
+    std::cout << "\033[0;33mBasic Solving Tests-----------------------\033[0m" << std::endl;
+
+    SatSolver solver;
+    solver.add_clause({pos('A'), pos('B')});
+    solver.add_clause({neg('A'), pos('B')});
+    solver.add_clause({pos('A'), neg('B')});
+    assert(solver.solve());
+    assert(solver.model_value(0) && solver.model_value(1));
+    std::cout << "(A|B) & (!A|B) & (A|!B): A=" << solver.model_value(0) << " B=" << solver.model_value(1) << std::endl;
+
+    // a clause added after solving makes it unsatisfiable for good
+    assert(!solver.add_clause({neg('A'), neg('B')}) || !solver.solve());
+    assert(!solver.okay() && !solver.solve());
+    assert(solver.failed_assumptions().empty());
+    std::cout << "\033[0;32m✓ Satisfiable and unsatisfiable clause sets\033[0m" << std::endl;
+
+    SatSolver php;
+    php.add_clauses(pigeonhole(6));
+    assert(!php.solve());
+    std::cout << "7 pigeons, 6 holes: unsatisfiable after " << php.stats().conflicts << " conflicts" << std::endl;
+
+    ClauseSet hard = random_3sat(200, 800, 5);
+    SatSolver random;
+    random.add_clauses(hard);
+    bool result = random.solve();
+    std::cout << "random 3-SAT, 200 variables, 800 clauses: " << (result ? "satisfiable" : "unsatisfiable")
+              << " after " << random.stats().conflicts << " conflicts" << std::endl;
+    assert(!result || model_satisfies(random, hard));
+    std::cout << "\033[0;32m✓ Pigeonhole and random 3-SAT\033[0m" << std::endl;
+}
+
+void test_assumptions() {
+    std::cout << "\n\033[0;33mAssumption Tests--------------------------\033[0m" << std::endl;
+
+    // A > B, B > C
+    SatSolver solver;
+    solver.add_formula("AB>BC>&");
+
+    assert(solver.solve({pos('A')}));
+    assert(solver.model_value('C' - 'A'));
+    std::cout << "A > B, B > C under A: C=" << solver.model_value('C' - 'A') << std::endl;
+
+    // D and E play no part, so they stay out of the core
+    assert(!solver.solve({pos('D'), pos('A'), neg('E'), neg('C')}));
+    std::vector<Literal> core = solver.failed_assumptions();
+    std::sort(core.begin(), core.end());
+    assert((core == std::vector<Literal>{pos('A'), neg('C')}));
+    std::cout << "under D, A, !E, !C: unsatisfiable, core {A, !C}" << std::endl;
+
+    // a failed call leaves the clauses satisfiable
+    assert(solver.okay() && solver.solve({neg('C')}));
+    assert(!solver.model_value(0));
+
+    assert(!solver.solve({pos('B'), neg('B')}));
+    assert(solver.failed_assumptions().size() == 2);
+    std::cout << "\033[0;32m✓ Failed-assumption cores\033[0m" << std::endl;
+}
+
+void test_incremental() {
+    std::cout << "\n\033[0;33mIncremental Query Tests-------------------\033[0m" << std::endl;
+
+    // a base formula and many related questions, each checked by brute force
+    GeneratorOptions options;
+    options.shape = FormulaShape::CNF_LIKE;
+    options.variables = 8;
+    options.clauses = 12;
+    options.clause_width = 3;
+    FormulaGenerator gen(17, options);
+    std::mt19937 rng(29);
+
+    int queries = 0, unsat = 0;
+    for (int base = 0; base < 10; ++base) {
+        std::string f = gen.next();
+        SatSolver solver;
+        solver.add_formula(f);
+        ClauseSet clauses = conjunctive_normal_form_clauses(f);
+
+        for (int q = 0; q < 40; ++q, ++queries) {
+            std::vector<Literal> assumptions;
+            for (int k = rng() % 4; k > 0; --k) assumptions.push_back(make_literal(rng() % 8, rng() & 1));
+
+            bool result = solver.solve(assumptions);
+            assert(result == sat(with_assumptions(f, assumptions)));
+            if (result) {
+                assert(model_satisfies(solver, clauses));
+                for (Literal a : assumptions) assert(solver.model_value(literal_variable(a)) != literal_negated(a));
+            } else {
+                ++unsat;
+                // the core is a subset of the assumptions that is unsatisfiable on its own
+                const std::vector<Literal> &core = solver.failed_assumptions();
+                for (Literal c : core) assert(std::count(assumptions.begin(), assumptions.end(), c));
+                assert(!sat(with_assumptions(f, core)));
+            }
+        }
+
+        // tighten the base between calls
+        Literal extra[2] = {make_literal(rng() % 8, rng() & 1), make_literal(rng() % 8, rng() & 1)};
+        solver.add_clause(extra, 2);
+        std::string g = f;
+        for (Literal l : extra) {
+            g += static_cast<char>('A' + literal_variable(l));
+            if (literal_negated(l)) g += '!';
+        }
+        assert(solver.solve() == sat(g + "|&"));
+    }
+    std::cout << queries << " queries on 10 base formulas, " << unsat << " unsatisfiable, all match sat()" << std::endl;
+    std::cout << "\033[0;32m✓ Assumption queries and added clauses\033[0m" << std::endl;
+
+    // learned clauses carry over: asking again costs fewer conflicts. The
+    // pigeonhole clauses only hold under the selector, so the solver stays
+    // satisfiable without it.
+    ClauseSet holes = pigeonhole(6);
+    SatSolver php;
+    Literal selector = make_literal(holes.variables(), false);
+    for (size_t i = 0; i < holes.size(); ++i) {
+        std::vector<Literal> c(holes.clause(i).begin(), holes.clause(i).end());
+        c.push_back(negate_literal(selector));
+        php.add_clause(c);
+    }
+    assert(!php.solve({selector}));
+    assert((php.failed_assumptions() == std::vector<Literal>{selector}));
+    uint64_t first = php.stats().conflicts;
+    assert(php.solve());
+    assert(!php.solve({selector}));
+    uint64_t second = php.stats().conflicts - first;
+    std::cout << "pigeonhole asked twice: " << first << " then " << second << " conflicts, "
+              << php.learnt_count() << " learned clauses kept" << std::endl;
+    assert(second < first);
+    std::cout << "\033[0;32m✓ Learned clauses are kept across calls\033[0m" << std::endl;
+}
+
+void test_limits() {
+    std::cout << "\n\033[0;33mResource Limit Tests----------------------\033[0m" << std::endl;
+
+    SatSolver solver;
+    solver.add_clauses(pigeonhole(9));
+
+    CancellationToken token;
+    token.cancel();
+    ResourceLimits limits;
+    limits.cancel = &token;
+    Limited<bool> r = solver.solve({}, limits);
+    assert(r.status == LIMIT_CANCELLED);
+
+    r = solver.solve({}, ResourceLimits::timeout(std::chrono::milliseconds(20)));
+    std::cout << "10 pigeons, 9 holes, 20 ms: " << limit_status_name(r.status) << std::endl;
+    assert(r.status == LIMIT_DEADLINE);
+
+    // the solver is still usable afterwards
+    solver.add_clause({make_literal(0, false)});
+    assert(solver.okay());
+    std::cout << "\033[0;32m✓ Deadlines and cancellation stop solve()\033[0m" << std::endl;
+}
+
+int main() {
+    test_basic();
+    test_assumptions();
+    test_incremental();
+    test_limits();
+    return 0;
+}
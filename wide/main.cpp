@@ -0,0 +1,160 @@
+// wide integer main
+
+#include <cassert>
+#include <random>
+#include "../wide_uint.hpp"
+
+using u128 = unsigned __int128;
+
+u128 to_native(const UInt128 &x) {
+    return (u128(x.limb(1)) << 64) | x.limb(0);
+}
+
+template <size_t Bits>
+WideUInt<Bits> random_wide(std::mt19937_64 &rng) {
+    std::array<uint64_t, Bits / 64> limbs;
+    // mostly random limbs, with runs of zeros and ones for long carry chains
+    for (uint64_t &limb : limbs) {
+        int kind = static_cast<int>(rng() % 4);
+        limb = kind == 0 ? 0 : kind == 1 ? ~uint64_t(0) : rng();
+    }
+    return WideUInt<Bits>(limbs);
+}
+
+// ripple-carry and schoolbook references on native 128-bit arithmetic
+template <size_t Bits>
+WideUInt<Bits> reference_add(const WideUInt<Bits> &a, const WideUInt<Bits> &b, uint64_t &carry) {
+    std::array<uint64_t, Bits / 64> limbs;
+    for (size_t i = 0; i < limbs.size(); ++i) {
+        u128 s = u128(a.limb(i)) + b.limb(i) + carry;
+        limbs[i] = static_cast<uint64_t>(s);
+        carry = static_cast<uint64_t>(s >> 64);
+    }
+    return WideUInt<Bits>(limbs);
+}
+
+template <size_t Bits>
+WideUInt<Bits> reference_mul(const WideUInt<Bits> &a, const WideUInt<Bits> &b) {
+    constexpr size_t n = Bits / 64;
+    std::array<uint64_t, n> limbs = {};
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t carry = 0;
+        for (size_t j = 0; i + j < n; ++j) {
+            u128 t = u128(a.limb(i)) * b.limb(j) + limbs[i + j] + carry;
+            limbs[i + j] = static_cast<uint64_t>(t);
+            carry = static_cast<uint64_t>(t >> 64);
+        }
+    }
+    return WideUInt<Bits>(limbs);
+}
+
+template <size_t Bits>
+void check_arithmetic(uint64_t seed, int rounds) {
+    std::mt19937_64 rng(seed);
+    for (int round = 0; round < rounds; ++round) {
+        WideUInt<Bits> a = random_wide<Bits>(rng), b = random_wide<Bits>(rng), c = random_wide<Bits>(rng);
+        uint64_t carry_in = rng() & 1, expected_carry = carry_in;
+        WideUInt<Bits> sum;
+        uint64_t carry = add_with_carry(a, b, sum, carry_in);
+        assert(sum == reference_add(a, b, expected_carry) && carry == expected_carry);
+
+        assert(a + b - b == a && a - a == WideUInt<Bits>() && a + -a == WideUInt<Bits>());
+        assert(a * b == reference_mul(a, b) && a * b == b * a);
+        assert(a * (b + c) == a * b + a * c);
+        uint64_t no_borrow = 1;
+        reference_add(a, ~b, no_borrow);
+        assert((a < b) == (no_borrow == 0));
+        assert((a < b) + (b < a) + (a == b) == 1);
+        assert(WideUInt<Bits>::from_hex(a.to_hex()) == a);
+        assert(wide_select(true, a, b) == a && wide_select(false, a, b) == b);
+
+        size_t shift = rng() % (Bits + 10);
+        WideUInt<Bits> shifted = a << shift, back = shifted >> shift;
+        if (shift < Bits) assert(back == (a & (~WideUInt<Bits>() >> shift)));
+        else assert(shifted == WideUInt<Bits>() && (a >> shift) == WideUInt<Bits>());
+    }
+}
+
+void test_arithmetic() {
+    std::cout << "\033[0;33mWide Integer Tests------------------------\033[0m" << std::endl;
+
+    UInt256 big = UInt256::from_hex("0xffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff");
+    UInt256 one(1), sum;
+    assert(add_with_carry(big, one, sum) == 1 && sum == UInt256());
+    assert((big + one).to_hex() == "0" && (UInt256() - one) == big);
+    assert((UInt256(1) << 200).to_hex() == "1" + std::string(50, '0'));
+    UInt128 x = UInt128::from_hex("123456789abcdef0fedcba9876543210");
+    std::cout << "0x" << x.to_hex() << " squared mod 2^128 = 0x" << (x * x).to_hex() << std::endl;
+    assert(to_native(x * x) == to_native(x) * to_native(x));
+    std::cout << "\033[0;32m✓ Carries across every limb\033[0m" << std::endl;
+
+    // 128 bits against the compiler's own
+    std::mt19937_64 rng(1);
+    for (int i = 0; i < 2000; ++i) {
+        UInt128 a = random_wide<128>(rng), b = random_wide<128>(rng);
+        u128 na = to_native(a), nb = to_native(b);
+        assert(to_native(a + b) == na + nb && to_native(a - b) == na - nb && to_native(a * b) == na * nb);
+        assert((a < b) == (na < nb) && to_native(-a) == 0 - na);
+    }
+    check_arithmetic<64>(2, 500);
+    check_arithmetic<128>(3, 500);
+    check_arithmetic<256>(4, 200);
+    check_arithmetic<512>(5, 50);
+    check_arithmetic<1024>(6, 20);
+    check_arithmetic<192>(7, 100);
+    std::cout << "\033[0;32m✓ 64 to 1024 bits match schoolbook arithmetic\033[0m" << std::endl;
+
+    // empty, not hex, 33 digits
+    for (const char *bad : {"", "0x", "12g4", "0x1" "0000000000000000" "0000000000000000"}) {
+        bool threw = false;
+        try {
+            UInt128::from_hex(bad);
+        } catch (const std::invalid_argument &) {
+            threw = true;
+        }
+        assert(threw);
+    }
+    std::cout << "\033[0;32m✓ Invalid hex rejected\033[0m" << std::endl;
+}
+
+template <size_t Bits>
+void check_batch(uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    for (size_t n : {size_t(0), size_t(1), size_t(3), size_t(4), size_t(5), size_t(8), size_t(13), size_t(64)}) {
+        std::vector<WideUInt<Bits>> a(n), b(n), out(n), portable(n);
+        for (size_t i = 0; i < n; ++i) {
+            a[i] = random_wide<Bits>(rng);
+            b[i] = random_wide<Bits>(rng);
+        }
+        wide_add(a.data(), b.data(), out.data(), n);
+        wide_batch_portable<Bits, WIDE_ADD>(a.data(), b.data(), portable.data(), n);
+        for (size_t i = 0; i < n; ++i) assert(out[i] == a[i] + b[i] && portable[i] == out[i]);
+        wide_sub(a.data(), b.data(), out.data(), n);
+        for (size_t i = 0; i < n; ++i) assert(out[i] == a[i] - b[i]);
+        wide_mul(a.data(), b.data(), out.data(), n);
+        wide_batch_portable<Bits, WIDE_MUL>(a.data(), b.data(), portable.data(), n);
+        for (size_t i = 0; i < n; ++i) assert(out[i] == a[i] * b[i] && portable[i] == out[i]);
+
+        // in place
+        std::vector<WideUInt<Bits>> c(a);
+        wide_add(c.data(), b.data(), c.data(), n);
+        for (size_t i = 0; i < n; ++i) assert(c[i] == a[i] + b[i]);
+    }
+}
+
+void test_batch() {
+    std::cout << "\n\033[0;33mWide Batch Tests--------------------------\033[0m" << std::endl;
+
+    check_batch<128>(11);
+    check_batch<256>(12);
+    check_batch<512>(13);
+    check_batch<1024>(14);
+    std::cout << "batch kernels: " << (wide_uint_uses_avx2() ? "AVX2" : "portable") << std::endl;
+    std::cout << "\033[0;32m✓ Batch add, sub and mul match the scalar operators\033[0m" << std::endl;
+}
+
+int main() {
+    test_arithmetic();
+    test_batch();
+    return 0;
+}
@@ -0,0 +1,342 @@
+#ifndef WIDE_UINT_HPP
+#define WIDE_UINT_HPP
+
+#include "boolean_algebra.hpp"
+
+// Fixed-width unsigned integers (128 to 1024 bits and beyond) of 64-bit
+// limbs: ex00's adder and ex01's multiplier past 32 bits.
+//
+// As in the exercises, the arithmetic is built from bitwise operations (and
+// 0 - bit, to spread a carry bit into a mask), and it runs in constant time:
+// no branch, loop bound or memory index depends on the operands, only on the
+// width. Shift counts are public, and so is the text from_hex parses.
+//
+// Addition is a two-level Kogge-Stone parallel-prefix adder. Within each
+// limb, the generate (a & b) and propagate (a ^ b) bits are combined over
+// spans of 1, 2, 4, ..., 32 bits, which gives the carry out of every bit with
+// no carry into the limb, and whether a carry into the limb would reach it:
+// six steps where ex00 loops once per carry. The limbs' top bits are then
+// combined the same way across limbs in log2(limbs) steps, and each limb's
+// carry in picks the final carries. Multiplication adds the partial products
+// (a << i) & b_i in carry-save form, three values to two with full adders, so
+// only the last addition propagates carries.
+//
+// The batch functions work on arrays of operands. Blocks of kWideLanes
+// operands are transposed so limb l of every operand sits side by side, and
+// every step of the adder is then one operation across the lanes, which the
+// compiler emits as vector instructions: SSE2 in a baseline build, and AVX2
+// from a second build of the same kernel where the CPU has it.
+
+// the kernels are inlined into each caller, so the AVX2 build of the batch
+// functions compiles them for AVX2 too
+#define WIDE_UINT_INLINE __attribute__((always_inline)) inline
+
+#define WIDE_UINT_AVX2 GRAY_CODE_AVX2
+
+constexpr size_t kWideLanes = 4;
+
+// The kernels below run on one 64-bit word per limb, or on WideLanes: limb l
+// of kWideLanes operands in one vector, every operation applied lane by lane
+typedef uint64_t WideLanes __attribute__((vector_size(8 * kWideLanes)));
+static_assert(kWideLanes == 4, "the batch kernel loads four operands per vector");
+
+// sum = a + b + carry, carry 0 or 1 in and out; sum may be a or b
+template <size_t Limbs, typename Word>
+WIDE_UINT_INLINE void wide_add_words(const Word *a, const Word *b, Word *sum, Word &carry) {
+    Word zero = {}, g[Limbs], p[Limbs], limb_g[Limbs], limb_p[Limbs];
+    for (size_t l = 0; l < Limbs; ++l) {
+        g[l] = a[l] & b[l];
+        p[l] = a[l] ^ b[l];
+    }
+
+    // bit i of g: the carry out of bit i with no carry into the limb; of p:
+    // a carry into the limb gets past bit i. Bits below the span let carries
+    // through, so p is filled with ones from the bottom.
+    for (unsigned span = 1; span < 64; span <<= 1) {
+        uint64_t fill = ~(~uint64_t(0) << span);
+        for (size_t l = 0; l < Limbs; ++l) {
+            g[l] |= p[l] & (g[l] << span);
+            p[l] &= (p[l] << span) | fill;
+        }
+    }
+
+    // the same across limbs on their top bits, spread to whole-word masks,
+    // with the carry in generated below limb 0; limb_g[l] is then the carry
+    // out of limb l
+    for (size_t l = 0; l < Limbs; ++l) {
+        limb_g[l] = zero - (g[l] >> 63);
+        limb_p[l] = zero - (p[l] >> 63);
+    }
+    Word in = zero - (carry & 1);
+    limb_g[0] |= limb_p[0] & in;
+    for (size_t span = 1; span < Limbs; span <<= 1) {
+        for (size_t l = Limbs; l-- > span;) {
+            limb_g[l] |= limb_p[l] & limb_g[l - span];
+            limb_p[l] &= limb_p[l - span];
+        }
+    }
+
+    for (size_t l = 0; l < Limbs; ++l) {
+        Word limb_in = l == 0 ? in : limb_g[l - 1];
+        sum[l] = a[l] ^ b[l] ^ (((g[l] | (p[l] & limb_in)) << 1) | (limb_in & 1));
+    }
+    carry = limb_g[Limbs - 1] & 1;
+}
+
+template <size_t Limbs, typename Word>
+WIDE_UINT_INLINE void wide_shift_left_one(Word *x) {
+    for (size_t l = Limbs; l-- > 1;) x[l] = (x[l] << 1) | (x[l - 1] >> 63);
+    x[0] <<= 1;
+}
+
+// product = a * b modulo 2^(64 * Limbs); product may be a or b
+template <size_t Limbs, typename Word>
+WIDE_UINT_INLINE void wide_mul_words(const Word *a, const Word *b, Word *product) {
+    Word zero = {}, shifted[Limbs], sum[Limbs], carries[Limbs], carry = zero;
+    for (size_t l = 0; l < Limbs; ++l) {
+        shifted[l] = a[l];
+        sum[l] = carries[l] = zero;
+    }
+
+    for (size_t bit = 0; bit < Limbs * 64; ++bit) {
+        Word select = zero - ((b[bit / 64] >> (bit % 64)) & 1);
+        for (size_t l = 0; l < Limbs; ++l) {
+            Word partial = shifted[l] & select, both = sum[l] ^ carries[l];
+            carries[l] = (sum[l] & carries[l]) | (partial & both);
+            sum[l] = both ^ partial;
+        }
+        wide_shift_left_one<Limbs>(carries);
+        wide_shift_left_one<Limbs>(shifted);
+    }
+    wide_add_words<Limbs>(sum, carries, product, carry);
+}
+
+template <size_t Bits>
+class WideUInt {
+    static_assert(Bits >= 64 && Bits % 64 == 0, "WideUInt takes a whole number of 64-bit limbs");
+
+public:
+    static constexpr size_t kLimbs = Bits / 64;
+
+    constexpr WideUInt() : limbs_{} {}
+    constexpr explicit WideUInt(uint64_t low) : limbs_{low} {}
+    // least significant limb first
+    constexpr explicit WideUInt(const std::array<uint64_t, kLimbs> &limbs) : limbs_(limbs) {}
+
+    // "0x" optional, at most Bits / 4 digits
+    static WideUInt from_hex(std::string_view hex) {
+        if (hex.size() >= 2 && hex[0] == '0' && (hex[1] == 'x' || hex[1] == 'X')) hex.remove_prefix(2);
+        if (hex.empty() || hex.size() > Bits / 4) {
+            throw std::invalid_argument("Error: expected 1 to " + std::to_string(Bits / 4) + " hex digits");
+        }
+        WideUInt value;
+        for (size_t i = 0; i < hex.size(); ++i) {
+            char c = static_cast<char>(std::tolower(static_cast<unsigned char>(hex[hex.size() - 1 - i])));
+            uint64_t digit;
+            if (c >= '0' && c <= '9') digit = static_cast<uint64_t>(c - '0');
+            else if (c >= 'a' && c <= 'f') digit = static_cast<uint64_t>(c - 'a' + 10);
+            else throw std::invalid_argument(std::string("Error: invalid hex digit '") + hex[hex.size() - 1 - i] + "'");
+            value.limbs_[i / 16] |= digit << (4 * (i % 16));
+        }
+        return value;
+    }
+
+    // no leading zeros, "0" for zero
+    std::string to_hex() const {
+        static const char digits[] = "0123456789abcdef";
+        std::string hex;
+        for (size_t i = Bits / 4; i-- > 0;) {
+            char c = digits[(limbs_[i / 16] >> (4 * (i % 16))) & 15];
+            if (!hex.empty() || c != '0' || i == 0) hex += c;
+        }
+        return hex;
+    }
+
+    uint64_t limb(size_t i) const { return limbs_[i]; }
+    const std::array<uint64_t, kLimbs> &limbs() const { return limbs_; }
+    uint64_t *data() { return limbs_.data(); }
+    const uint64_t *data() const { return limbs_.data(); }
+
+    // sum = a + b + carry (0 or 1); returns the carry out
+    friend uint64_t add_with_carry(const WideUInt &a, const WideUInt &b, WideUInt &sum, uint64_t carry = 0) {
+        wide_add_words<kLimbs>(a.data(), b.data(), sum.data(), carry);
+        return carry;
+    }
+
+    friend WideUInt operator+(const WideUInt &a, const WideUInt &b) {
+        WideUInt sum;
+        add_with_carry(a, b, sum);
+        return sum;
+    }
+
+    friend WideUInt operator-(const WideUInt &a, const WideUInt &b) {
+        WideUInt difference;
+        add_with_carry(a, ~b, difference, 1);
+        return difference;
+    }
+
+    WideUInt operator-() const { return WideUInt() - *this; }
+
+    friend WideUInt operator*(const WideUInt &a, const WideUInt &b) {
+        WideUInt product;
+        wide_mul_words<kLimbs>(a.data(), b.data(), product.data());
+        return product;
+    }
+
+    friend WideUInt operator&(WideUInt a, const WideUInt &b) {
+        for (size_t i = 0; i < kLimbs; ++i) a.limbs_[i] &= b.limbs_[i];
+        return a;
+    }
+
+    friend WideUInt operator|(WideUInt a, const WideUInt &b) {
+        for (size_t i = 0; i < kLimbs; ++i) a.limbs_[i] |= b.limbs_[i];
+        return a;
+    }
+
+    friend WideUInt operator^(WideUInt a, const WideUInt &b) {
+        for (size_t i = 0; i < kLimbs; ++i) a.limbs_[i] ^= b.limbs_[i];
+        return a;
+    }
+
+    WideUInt operator~() const {
+        WideUInt inverted;
+        for (size_t i = 0; i < kLimbs; ++i) inverted.limbs_[i] = ~limbs_[i];
+        return inverted;
+    }
+
+    // shift counts are public: they pick limbs, shifts of Bits or more give 0
+    WideUInt operator<<(size_t shift) const {
+        WideUInt shifted;
+        size_t words = shift / 64, bits = shift % 64;
+        for (size_t i = kLimbs; i-- > words;) {
+            shifted.limbs_[i] = limbs_[i - words] << bits;
+            if (bits && i > words) shifted.limbs_[i] |= limbs_[i - words - 1] >> (64 - bits);
+        }
+        return shifted;
+    }
+
+    WideUInt operator>>(size_t shift) const {
+        WideUInt shifted;
+        size_t words = shift / 64, bits = shift % 64;
+        for (size_t i = 0; i + words < kLimbs; ++i) {
+            shifted.limbs_[i] = limbs_[i + words] >> bits;
+            if (bits && i + words + 1 < kLimbs) shifted.limbs_[i] |= limbs_[i + words + 1] << (64 - bits);
+        }
+        return shifted;
+    }
+
+    WideUInt &operator+=(const WideUInt &b) { return *this = *this + b; }
+    WideUInt &operator-=(const WideUInt &b) { return *this = *this - b; }
+    WideUInt &operator*=(const WideUInt &b) { return *this = *this * b; }
+
+    // the comparisons look at every limb whatever the answer
+    friend bool operator==(const WideUInt &a, const WideUInt &b) {
+        uint64_t differ = 0;
+        for (size_t i = 0; i < kLimbs; ++i) differ |= a.limbs_[i] ^ b.limbs_[i];
+        return differ == 0;
+    }
+
+    friend bool operator!=(const WideUInt &a, const WideUInt &b) { return !(a == b); }
+
+    // a < b when a - b borrows, that is a + ~b + 1 does not carry out
+    friend bool operator<(const WideUInt &a, const WideUInt &b) {
+        WideUInt difference;
+        return add_with_carry(a, ~b, difference, 1) == 0;
+    }
+
+    friend bool operator>(const WideUInt &a, const WideUInt &b) { return b < a; }
+    friend bool operator<=(const WideUInt &a, const WideUInt &b) { return !(b < a); }
+    friend bool operator>=(const WideUInt &a, const WideUInt &b) { return !(a < b); }
+
+private:
+    std::array<uint64_t, kLimbs> limbs_;
+};
+
+using UInt128 = WideUInt<128>;
+using UInt256 = WideUInt<256>;
+using UInt512 = WideUInt<512>;
+using UInt1024 = WideUInt<1024>;
+
+// choose ? a : b without a branch
+template <size_t Bits>
+WideUInt<Bits> wide_select(bool choose, const WideUInt<Bits> &a, const WideUInt<Bits> &b) {
+    uint64_t mask = uint64_t(0) - static_cast<uint64_t>(choose);
+    std::array<uint64_t, Bits / 64> limbs;
+    for (size_t i = 0; i < limbs.size(); ++i) limbs[i] = (a.limb(i) & mask) | (b.limb(i) & ~mask);
+    return WideUInt<Bits>(limbs);
+}
+
+// Batch arithmetic: out[i] = a[i] op b[i], out may be a or b
+
+enum WideOp { WIDE_ADD, WIDE_SUB, WIDE_MUL };
+
+template <size_t Bits, WideOp Op>
+WIDE_UINT_INLINE void wide_batch_kernel(const WideUInt<Bits> *a, const WideUInt<Bits> *b, WideUInt<Bits> *out, size_t n) {
+    constexpr size_t kLimbs = WideUInt<Bits>::kLimbs;
+    size_t i = 0;
+    for (; i + kWideLanes <= n; i += kWideLanes) {
+        WideLanes x[kLimbs], y[kLimbs], z[kLimbs], carry = {};
+        for (size_t l = 0; l < kLimbs; ++l) {
+            x[l] = WideLanes{a[i].limb(l), a[i + 1].limb(l), a[i + 2].limb(l), a[i + 3].limb(l)};
+            y[l] = WideLanes{b[i].limb(l), b[i + 1].limb(l), b[i + 2].limb(l), b[i + 3].limb(l)};
+        }
+        if (Op == WIDE_SUB) {
+            for (size_t l = 0; l < kLimbs; ++l) y[l] = ~y[l];
+            carry |= 1;
+        }
+        if (Op == WIDE_MUL) wide_mul_words<kLimbs>(x, y, z);
+        else wide_add_words<kLimbs>(x, y, z, carry);
+        for (size_t j = 0; j < kWideLanes; ++j) {
+            uint64_t *limbs = out[i + j].data();
+            for (size_t l = 0; l < kLimbs; ++l) limbs[l] = z[l][j];
+        }
+    }
+    for (; i < n; ++i) {
+        if (Op == WIDE_ADD) out[i] = a[i] + b[i];
+        else if (Op == WIDE_SUB) out[i] = a[i] - b[i];
+        else out[i] = a[i] * b[i];
+    }
+}
+
+template <size_t Bits, WideOp Op>
+void wide_batch_portable(const WideUInt<Bits> *a, const WideUInt<Bits> *b, WideUInt<Bits> *out, size_t n) {
+    wide_batch_kernel<Bits, Op>(a, b, out, n);
+}
+
+#if WIDE_UINT_AVX2
+template <size_t Bits, WideOp Op>
+__attribute__((target("avx2"))) void wide_batch_avx2(const WideUInt<Bits> *a, const WideUInt<Bits> *b,
+                                                     WideUInt<Bits> *out, size_t n) {
+    wide_batch_kernel<Bits, Op>(a, b, out, n);
+}
+#endif
+
+// the same CPU check as the Gray code kernels
+inline bool wide_uint_uses_avx2() {
+    return gray_code_uses_avx2();
+}
+
+template <size_t Bits, WideOp Op>
+void wide_batch(const WideUInt<Bits> *a, const WideUInt<Bits> *b, WideUInt<Bits> *out, size_t n) {
+#if WIDE_UINT_AVX2
+    if (wide_uint_uses_avx2()) return wide_batch_avx2<Bits, Op>(a, b, out, n);
+#endif
+    wide_batch_portable<Bits, Op>(a, b, out, n);
+}
+
+template <size_t Bits>
+void wide_add(const WideUInt<Bits> *a, const WideUInt<Bits> *b, WideUInt<Bits> *out, size_t n) {
+    wide_batch<Bits, WIDE_ADD>(a, b, out, n);
+}
+
+template <size_t Bits>
+void wide_sub(const WideUInt<Bits> *a, const WideUInt<Bits> *b, WideUInt<Bits> *out, size_t n) {
+    wide_batch<Bits, WIDE_SUB>(a, b, out, n);
+}
+
+template <size_t Bits>
+void wide_mul(const WideUInt<Bits> *a, const WideUInt<Bits> *b, WideUInt<Bits> *out, size_t n) {
+    wide_batch<Bits, WIDE_MUL>(a, b, out, n);
+}
+
+#endif